@@ -0,0 +1,91 @@
+; mon_bench.s - Llamada cronometrada para J (benchmark)
+;
+; mon_bench_call entra en _mon_bench_addr con A/X/Y de _mon_bench_regs
+; y lee el contador libre de ciclos justo antes y justo después; deja
+; la diferencia en _mon_bench_ticks. La rutina vuelve con su RTS como si
+; la hubiera llamado un JSR (la dirección de vuelta se apila a mano, así
+; no hace falta JMP (ind) con su fallo de página). El coste fijo de
+; lectura y entrada se mide igual con mon_bench_nop, que solo hace RTS.
+;
+; Contador ($C010-$C013, little endian, +1 por ciclo): leer el byte bajo
+; congela los tres altos hasta la siguiente lectura del bajo, de modo que
+; los 4 bytes son del mismo instante. Si no existe, las lecturas no
+; cambian y la diferencia es 0 (lo comprueba el monitor).
+
+        .export         _mon_bench_call, _mon_bench_nop
+        .export         _mon_bench_addr, _mon_bench_regs, _mon_bench_ticks
+
+BENCH_COUNTER   = $C010
+
+.segment "BSS"
+
+_mon_bench_addr:    .res    2       ; Rutina a llamar
+_mon_bench_regs:    .res    3       ; A, X, Y de entrada
+_mon_bench_ticks:   .res    4       ; Ciclos de la última llamada
+bench_start:        .res    4
+bench_target:       .res    2       ; Rutina - 1 (para el RTS de entrada)
+
+.segment "CODE"
+
+; ---------------------------------------------------------------
+; void mon_bench_call(void)
+; ---------------------------------------------------------------
+_mon_bench_call:
+        php                     ; D e I del monitor
+        lda     _mon_bench_addr
+        sec
+        sbc     #1
+        sta     bench_target
+        lda     _mon_bench_addr+1
+        sbc     #0
+        sta     bench_target+1
+
+        lda     #>(@ret - 1)    ; Vuelta de la rutina
+        pha
+        lda     #<(@ret - 1)
+        pha
+        lda     bench_target+1  ; Entrada por RTS
+        pha
+        lda     bench_target
+        pha
+
+        lda     BENCH_COUNTER   ; Congela los bytes altos
+        sta     bench_start
+        lda     BENCH_COUNTER+1
+        sta     bench_start+1
+        lda     BENCH_COUNTER+2
+        sta     bench_start+2
+        lda     BENCH_COUNTER+3
+        sta     bench_start+3
+
+        lda     _mon_bench_regs
+        ldx     _mon_bench_regs+1
+        ldy     _mon_bench_regs+2
+        rts
+
+@ret:   lda     BENCH_COUNTER
+        sta     _mon_bench_ticks
+        lda     BENCH_COUNTER+1
+        sta     _mon_bench_ticks+1
+        lda     BENCH_COUNTER+2
+        sta     _mon_bench_ticks+2
+        lda     BENCH_COUNTER+3
+        sta     _mon_bench_ticks+3
+        plp
+
+        sec                     ; ticks = fin - inicio
+        ldx     #0
+        ldy     #4
+@sub:   lda     _mon_bench_ticks,x
+        sbc     bench_start,x
+        sta     _mon_bench_ticks,x
+        inx
+        dey
+        bne     @sub
+        rts
+
+; ---------------------------------------------------------------
+; void mon_bench_nop(void) - rutina vacía para medir el coste fijo
+; ---------------------------------------------------------------
+_mon_bench_nop:
+        rts
@@ -0,0 +1,39 @@
+; mon_map.s - Mapa de memoria del enlazador para I, S, T y V
+;
+; Las zonas salen de config/fpga.cfg al enlazar (áreas y segmentos con
+; define = yes), así que siguen al .cfg sin tocar monitor.c. Cada entrada
+; es inicio y fin inclusive; inicio > fin es una zona vacía.
+;
+;   _mon_map_free  lo que el monitor no usa, en orden de direcciones
+;       0  zero page tras el segmento ZEROPAGE del runtime
+;       1  área RAM (programas de usuario)
+;       2  resto de MONRAM tras VECRAM, BSS y NOINIT
+;   _mon_map_own   lo que sí usa
+;       0  segmento ZEROPAGE
+;       1  VECRAM + BSS + NOINIT
+;       2  pila C
+;
+; NOINIT debe ser el último segmento de MONRAM en el .cfg.
+
+        .export         _mon_map_free, _mon_map_own
+
+        .import         __ZEROPAGE_RUN__, __ZEROPAGE_SIZE__
+        .import         __RAM_START__, __RAM_SIZE__
+        .import         __MONRAM_START__, __MONRAM_SIZE__
+        .import         __NOINIT_RUN__, __NOINIT_SIZE__
+        .import         __STACKSTART__, __STACKSIZE__
+
+ZP_FREE         = __ZEROPAGE_RUN__ + __ZEROPAGE_SIZE__
+MONRAM_FREE     = __NOINIT_RUN__ + __NOINIT_SIZE__
+
+.segment "RODATA"
+
+_mon_map_free:
+        .word   ZP_FREE, $00FF
+        .word   __RAM_START__, __RAM_START__ + __RAM_SIZE__ - 1
+        .word   MONRAM_FREE, __MONRAM_START__ + __MONRAM_SIZE__ - 1
+
+_mon_map_own:
+        .word   __ZEROPAGE_RUN__, ZP_FREE - 1
+        .word   __MONRAM_START__, MONRAM_FREE - 1
+        .word   __STACKSTART__ - __STACKSIZE__ + 1, __STACKSTART__
@@ -0,0 +1,129 @@
+; mon_stack.s - Sondas de uso de pila y zero page para G addr P
+;
+; mon_probe_paint rellena con PROBE_FILL la parte libre de:
+;   - la pila HW ($0100 hasta el S de entrada del programa, inclusive)
+;   - la pila C (desde el fondo de STACK hasta sp)
+;   - la zero page no usada por el runtime (tras el segmento ZEROPAGE)
+; mon_probe_collect, llamado justo al volver del programa, busca desde el
+; fondo el primer byte modificado de cada pila (solo recorre la parte que
+; siguió intacta). La zero page se revisa después desde C.
+
+        .export         _mon_probe_paint, _mon_probe_collect
+        .export         _mon_probe_s, _mon_probe_csp
+        .export         _mon_probe_hw_low, _mon_probe_c_low, _mon_probe_zp
+
+        .import         __ZEROPAGE_RUN__, __ZEROPAGE_SIZE__
+        .import         __STACKSTART__, __STACKSIZE__
+        .import         _mon_ctx
+        .importzp       sp, ptr1
+
+PROBE_FILL      = $A5
+CSTACK_BOTTOM   = __STACKSTART__ - __STACKSIZE__ + 1
+CSTACK_TOP      = __STACKSTART__ + 1
+
+.segment "BSS"
+
+_mon_probe_s:       .res    1       ; S de entrada del programa
+_mon_probe_hw_low:  .res    1       ; Byte más bajo modificado en página 1
+_mon_probe_csp:     .res    2       ; Fin de la zona pintada de la pila C
+_mon_probe_c_low:   .res    2       ; Byte más bajo modificado en la pila C
+
+.segment "RODATA"
+
+_mon_probe_zp:      .byte   <(__ZEROPAGE_RUN__ + __ZEROPAGE_SIZE__)
+
+.segment "CODE"
+
+; ---------------------------------------------------------------
+; void mon_probe_paint(void)
+; ---------------------------------------------------------------
+_mon_probe_paint:
+        ; Pila HW: del S con que entrará el programa (mon_ctx, ver
+        ; mon_step.s) hacia abajo; lo de encima es del monitor.
+        ldx     _mon_ctx+6
+        stx     _mon_probe_s
+        lda     #PROBE_FILL
+@hw:    sta     $0100,x
+        dex
+        cpx     #$FF
+        bne     @hw
+
+        ; Zero page libre
+        ldx     _mon_probe_zp
+@zp:    sta     $00,x
+        inx
+        bne     @zp
+
+        ; Pila C: fin = min(sp, CSTACK_TOP)
+        lda     sp
+        ldx     sp+1
+        cpx     #>CSTACK_TOP
+        bcc     @end
+        bne     @top
+        cmp     #<CSTACK_TOP
+        bcc     @end
+@top:   lda     #<CSTACK_TOP
+        ldx     #>CSTACK_TOP
+@end:   sta     _mon_probe_csp
+        stx     _mon_probe_csp+1
+
+        lda     #<CSTACK_BOTTOM
+        sta     ptr1
+        lda     #>CSTACK_BOTTOM
+        sta     ptr1+1
+        ldy     #0
+@cs:    lda     ptr1
+        cmp     _mon_probe_csp
+        bne     @fill
+        lda     ptr1+1
+        cmp     _mon_probe_csp+1
+        beq     @done
+@fill:  lda     #PROBE_FILL
+        sta     (ptr1),y
+        inc     ptr1
+        bne     @cs
+        inc     ptr1+1
+        bne     @cs
+@done:  rts
+
+; ---------------------------------------------------------------
+; void mon_probe_collect(void)
+; ---------------------------------------------------------------
+_mon_probe_collect:
+        ; Pila HW: primer byte distinto desde $0100 (S+1 si ninguno)
+        ldx     #0
+        lda     #PROBE_FILL
+@hw:    cmp     $0100,x
+        bne     @hwok
+        cpx     _mon_probe_s
+        beq     @hwnone
+        inx
+        bne     @hw
+@hwnone:
+        inx
+@hwok:  stx     _mon_probe_hw_low
+
+        ; Pila C: primer byte distinto desde el fondo (fin si ninguno)
+        lda     #<CSTACK_BOTTOM
+        sta     ptr1
+        lda     #>CSTACK_BOTTOM
+        sta     ptr1+1
+        ldy     #0
+@cs:    lda     ptr1
+        cmp     _mon_probe_csp
+        bne     @chk
+        lda     ptr1+1
+        cmp     _mon_probe_csp+1
+        beq     @csok
+@chk:   lda     (ptr1),y
+        cmp     #PROBE_FILL
+        bne     @csok
+        inc     ptr1
+        bne     @cs
+        inc     ptr1+1
+        bne     @cs
+@csok:  lda     ptr1
+        sta     _mon_probe_c_low
+        lda     ptr1+1
+        sta     _mon_probe_c_low+1
+        rts
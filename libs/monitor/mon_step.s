@@ -0,0 +1,131 @@
+; mon_step.s - Cambio de contexto para paso a paso y traza (X, Y, Z)
+;
+; El monitor ejecuta el programa depurado de instrucción en instrucción
+; parcheando un BRK en la siguiente instrucción. mon_ctx_go restaura los
+; registros guardados en _mon_ctx y entra con RTI; el BRK (vector en RAM,
+; ver mon_vectors.s) llega a mon_ctx_brk, que guarda los registros y
+; vuelve a C con la pila del monitor.
+;
+;   _mon_ctx+0  PC (dirección del BRK al volver)
+;   _mon_ctx+2  A
+;   _mon_ctx+3  X
+;   _mon_ctx+4  Y
+;   _mon_ctx+5  P
+;   _mon_ctx+6  S
+;
+; mon_ctx_go y ctx_leave leen el contador libre de ciclos ($C010, ver
+; mon_bench.s) en _mon_ctx_t0 y _mon_ctx_t1: la diferencia son los
+; ciclos del programa más un coste fijo del cambio de contexto (ver
+; CTX_*_CYCLES en monitor.c). Sin contador no significa nada.
+;
+; El programa usa su propia zona de la página 1 (por debajo de la del
+; monitor) y, si termina con RTS al nivel superior, vuelve a
+; mon_ctx_exit, cuya dirección - 1 deja C en la pila al empezar.
+
+        .export         _mon_ctx, _mon_ctx_go, _mon_ctx_brk, _mon_ctx_exit
+        .export         _mon_ctx_t0, _mon_ctx_t1
+
+CTX_BRK         = 0             ; Parado en un BRK
+CTX_EXIT        = 1             ; RTS del nivel superior
+
+CTX_COUNTER     = $C010         ; Como BENCH_COUNTER en mon_bench.s
+
+.segment "BSS"
+
+_mon_ctx:       .res    7
+ctx_msp:        .res    1       ; S del monitor
+ctx_mp:         .res    1       ; P del monitor
+_mon_ctx_t0:    .res    4       ; Contador al entrar
+_mon_ctx_t1:    .res    4       ; Contador al volver
+
+.segment "CODE"
+
+; ---------------------------------------------------------------
+; uint8_t mon_ctx_go(void)
+; Entra en el programa con el contexto guardado; retorna CTX_BRK o
+; CTX_EXIT con _mon_ctx actualizado
+; ---------------------------------------------------------------
+_mon_ctx_go:
+        php
+        pla
+        sta     ctx_mp
+        tsx
+        stx     ctx_msp
+
+        ldx     _mon_ctx+6
+        txs
+        lda     _mon_ctx+1      ; PC alto
+        pha
+        lda     _mon_ctx        ; PC bajo
+        pha
+        lda     _mon_ctx+5      ; P
+        pha
+        lda     CTX_COUNTER     ; Congela los bytes altos
+        sta     _mon_ctx_t0
+        lda     CTX_COUNTER+1
+        sta     _mon_ctx_t0+1
+        lda     CTX_COUNTER+2
+        sta     _mon_ctx_t0+2
+        lda     CTX_COUNTER+3
+        sta     _mon_ctx_t0+3
+        lda     _mon_ctx+2
+        ldx     _mon_ctx+3
+        ldy     _mon_ctx+4
+        rti
+
+; ---------------------------------------------------------------
+; Manejador de BRK: pila = P, PCL, PCH (PC = BRK + 2)
+; ---------------------------------------------------------------
+_mon_ctx_brk:
+        sta     _mon_ctx+2
+        stx     _mon_ctx+3
+        sty     _mon_ctx+4
+        pla
+        sta     _mon_ctx+5
+        pla
+        sec
+        sbc     #2
+        sta     _mon_ctx
+        pla
+        sbc     #0
+        sta     _mon_ctx+1
+        lda     #CTX_BRK
+        jmp     ctx_leave
+
+; ---------------------------------------------------------------
+; Retorno del nivel superior: el PC queda en la dirección de salida
+; ---------------------------------------------------------------
+_mon_ctx_exit:
+        php
+        sta     _mon_ctx+2
+        stx     _mon_ctx+3
+        sty     _mon_ctx+4
+        pla
+        sta     _mon_ctx+5
+        lda     #<_mon_ctx_exit
+        sta     _mon_ctx
+        lda     #>_mon_ctx_exit
+        sta     _mon_ctx+1
+        lda     #CTX_EXIT
+
+; Guardar S del programa y volver a C con la pila y el P del monitor
+ctx_leave:
+        tay                     ; Motivo
+        lda     CTX_COUNTER
+        sta     _mon_ctx_t1
+        lda     CTX_COUNTER+1
+        sta     _mon_ctx_t1+1
+        lda     CTX_COUNTER+2
+        sta     _mon_ctx_t1+2
+        lda     CTX_COUNTER+3
+        sta     _mon_ctx_t1+3
+        tsx
+        stx     _mon_ctx+6
+        ldx     ctx_msp
+        txs
+        lda     ctx_mp
+        pha
+        plp
+        tya
+        ldx     #0
+        rts
@@ -0,0 +1,124 @@
+; mon_vectors.s - Despacho de NMI/IRQ/BRK a través de vectores en RAM
+;
+; Los vectores de ROM ($9FFA/$9FFE) apuntan a mon_nmi_entry y
+; mon_irq_entry, que saltan con JMP (vector) a una tabla en RAM
+; (segmento VECRAM, fijo en $3A00):
+;
+;   $3A00-$3A01  NMI
+;   $3A02-$3A03  IRQ (hardware)
+;   $3A04-$3A05  BRK
+;   $3A06        Cerrojo: con el bit 7 a 1 el NMI se ignora (RTI)
+;
+; SEI no enmascara el NMI: mientras se escriben los dos bytes de un
+; vector, un NMI podría saltar a una dirección a medio escribir. Por eso
+; la escritura se hace con el cerrojo puesto; un NMI que llegue entonces
+; se pierde en vez de saltar a cualquier sitio.
+;
+; Un programa cargado puede instalar su manejador sin regenerar la ROM:
+;   - desde C: mon_vec_install(MON_VEC_IRQ, handler) devuelve el anterior
+;   - desde ASM: guardar el vector anterior y escribir el nuevo con SEI
+;     (el de NMI, además, con $FF en el cerrojo y 0 al terminar)
+; Para encadenar, el manejador termina con JMP (anterior) en vez de RTI.
+; El monitor restaura los valores por defecto al recuperar el control.
+
+        .export         mon_nmi_entry, mon_irq_entry
+        .export         _mon_vec_install, _mon_vec_reset
+        .export         _mon_nmi_vec, _mon_irq_vec, _mon_brk_vec, _mon_vec_lock
+
+        .import         incsp1
+        .importzp       sp, ptr1
+
+.segment "VECRAM"
+
+_mon_nmi_vec:   .res    2
+_mon_irq_vec:   .res    2
+_mon_brk_vec:   .res    2
+_mon_vec_lock:  .res    1
+
+.segment "CODE"
+
+; ---------------------------------------------------------------
+; NMI: salto al vector salvo con el cerrojo puesto (11 ciclos sobre la
+; entrada de la CPU)
+; ---------------------------------------------------------------
+mon_nmi_entry:
+        bit     _mon_vec_lock
+        bmi     mon_default_handler
+        jmp     (_mon_nmi_vec)
+
+; ---------------------------------------------------------------
+; IRQ/BRK: distinguir por el bit B del P apilado y saltar al vector
+; correspondiente con A, X y la pila intactos.
+; ---------------------------------------------------------------
+mon_irq_entry:
+        pha
+        txa
+        pha
+        tsx
+        lda     $0103,x         ; P apilado por la CPU
+        and     #$10            ; bit B
+        bne     @brk
+        pla
+        tax
+        pla
+        jmp     (_mon_irq_vec)
+@brk:   pla
+        tax
+        pla
+        jmp     (_mon_brk_vec)
+
+; Manejador por defecto: retorno inmediato
+mon_default_handler:
+        rti
+
+; ---------------------------------------------------------------
+; uint16_t __fastcall__ mon_vec_install(uint8_t vec, code_ptr handler)
+; Instala 'handler' en el vector 'vec' (0=NMI, 1=IRQ, 2=BRK) y devuelve
+; el manejador anterior para poder encadenarlo. SEI aparta IRQ y BRK y
+; el cerrojo, el NMI: ninguno ve el vector a medio escribir.
+; ---------------------------------------------------------------
+_mon_vec_install:
+        sta     ptr1            ; Nuevo manejador
+        stx     ptr1+1
+        ldy     #0
+        lda     (sp),y          ; Índice de vector
+        asl     a
+        tay
+        php
+        sei
+        lda     #$FF
+        sta     _mon_vec_lock
+        lda     _mon_nmi_vec+1,y
+        tax                     ; X = anterior (alto)
+        lda     ptr1+1
+        sta     _mon_nmi_vec+1,y
+        lda     _mon_nmi_vec,y
+        pha                     ; Anterior (bajo)
+        lda     ptr1
+        sta     _mon_nmi_vec,y
+        inc     _mon_vec_lock   ; $FF -> 0
+        pla
+        plp
+        jmp     incsp1          ; Descartar 'vec' de la pila C
+
+; ---------------------------------------------------------------
+; void mon_vec_reset(void)
+; Restaura los tres vectores al manejador por defecto (RTI) y deja el
+; cerrojo abierto
+; ---------------------------------------------------------------
+_mon_vec_reset:
+        php
+        sei
+        lda     #$FF
+        sta     _mon_vec_lock
+        lda     #<mon_default_handler
+        ldx     #>mon_default_handler
+        sta     _mon_nmi_vec
+        stx     _mon_nmi_vec+1
+        sta     _mon_irq_vec
+        stx     _mon_irq_vec+1
+        sta     _mon_brk_vec
+        stx     _mon_brk_vec+1
+        inc     _mon_vec_lock   ; $FF -> 0
+        plp
+        rts
@@ -4,31 +4,242 @@
  * Implementación de interfaz de comandos estilo Wozmon/Supermon
  */
 
+#include <string.h>
 #include "monitor.h"
+#include "mon_strings.h"
 #include "../uart/uart.h"
 
 /* Buffer de entrada */
 static char input_buffer[MON_BUFFER_SIZE];
 static uint8_t input_pos;
 
-/* Última dirección usada (para comandos continuos) */
-static uint16_t last_addr = 0x0200;
+/* Última dirección usada (para comandos continuos)
+ * Sin inicializador: DATA está en ROM; monitor_init la pone a $0200 en
+ * frío. En NOINIT (crt0 no lo borra) para conservarla en caliente */
+#pragma bss-name (push, "NOINIT")
+static uint16_t last_addr;
+#pragma bss-name (pop)
+
+/* Tipo del último arranque (monitor_init) o reinicio tras Q */
+#define MON_BOOT_RESTART 2
+static uint8_t boot_state;
+static uint8_t warm_kept;
+static uint8_t warm_dropped;
+
+/* Tabla de mensajes comprimida (build/mon_strings.s, ver mkstrings.py) */
+extern const uint8_t mon_msg_pairs[];
+extern const uint8_t mon_msg_text[];
 
 /* Tabla de caracteres hex */
 static const char hex_chars[] = "0123456789ABCDEF";
 
+/* Registros de la UART (ver libs/uart): mon_putc/mon_getc sondean el estado
+ * una sola vez por byte y acceden al dato directamente */
+#define MON_UART_DATA      (*(volatile uint8_t*)0xC020)
+#define MON_UART_STATUS    (*(volatile uint8_t*)0xC021)
+#ifndef MON_UART_RX_VALID
+#define MON_UART_RX_VALID  0x02
+#endif
+
+#ifndef MON_UART_TX_READY
+#define MON_UART_TX_READY  0x01
+#endif
+
+/* La UART tiene un carácter recibido (no bloquea) */
+#define mon_uart_rx_ready() (MON_UART_STATUS & MON_UART_RX_VALID)
+
+/* Hay un carácter esperando: adelantado por mon_abort o en la UART */
+#define mon_rx_ready()     (rx_count != 0 || mon_uart_rx_ready())
+
+/* Medidor opcional en dos LEDs del puerto de src/main.c (-DMON_LED_METER):
+ * OCUPADO se apaga mientras se espera a la UART y ACTIVIDAD cambia con
+ * cada byte RX/TX. Lectura-modificación-escritura: el resto de bits no
+ * se tocan */
+#ifdef MON_LED_METER
+#define MON_LED_PORT       (*(volatile uint8_t*)0xC001)
+#ifndef MON_LED_BUSY
+#define MON_LED_BUSY       0x10
+#endif
+#ifndef MON_LED_ACT
+#define MON_LED_ACT        0x20
+#endif
+#define led_busy_on()      (MON_LED_PORT |= MON_LED_BUSY)
+#define led_busy_off()     (MON_LED_PORT &= (uint8_t)~MON_LED_BUSY)
+#define led_activity()     (MON_LED_PORT ^= MON_LED_ACT)
+#else
+#define led_busy_on()
+#define led_busy_off()
+#define led_activity()
+#endif
+
+/* Teclas que abortan un comando largo */
+#define KEY_ESC            0x1B
+#define KEY_CTRL_C         0x03
+
+/* Iteraciones de sondeo por tick (~10 ms a 3.375 MHz) */
+#define MON_TICK_LOOPS     800
+
+/* Sondas de pila y zero page (mon_stack.s) */
+#define MON_PROBE_FILL  0xA5
+void mon_probe_paint(void);
+void mon_probe_collect(void);
+extern uint8_t  mon_probe_s;
+extern uint8_t  mon_probe_hw_low;
+extern uint16_t mon_probe_csp;
+extern uint16_t mon_probe_c_low;
+extern const uint8_t mon_probe_zp;
+
+/* Llamada cronometrada con el contador libre de ciclos (mon_bench.s) */
+void mon_bench_call(void);
+void mon_bench_nop(void);
+extern uint16_t mon_bench_addr;
+extern uint8_t  mon_bench_regs[3];
+extern uint32_t mon_bench_ticks;
+
+/* Byte bajo del contador libre de ciclos (BENCH_COUNTER en mon_bench.s) */
+#define MON_COUNTER_LO  (*(volatile uint8_t*)0xC010)
+
+/* Avance máximo del byte bajo entre dos lecturas seguidas */
+#define COUNTER_STEP_MAX 64
+
+/* Medir pila/zero page en la próxima ejecución (G addr P) */
+static uint8_t exec_probe;
+
+/* Lecturas del registro de estado en mon_putc/mon_getc: las que
+ * encontraron la UART lista (una por byte) y las que la encontraron
+ * ocupada (transmisor lleno / sin carácter) */
+typedef struct {
+    uint32_t tx_ready;              /* Sondeos con el transmisor libre */
+    uint32_t tx_busy;               /* Sondeos con el transmisor ocupado */
+    uint32_t rx_ready;              /* Sondeos con un carácter */
+    uint32_t rx_busy;               /* Sondeos sin carácter */
+} mon_wait_t;
+
+/* Estadísticas de la sesión (comando #): monitor_init las pone a cero
+ * y sobreviven a Q, porque monitor_run no las toca */
+#define STAT_LETTERS    26
+
+typedef struct {
+    uint16_t cmds[STAT_LETTERS];    /* Comandos por letra A-Z */
+    uint16_t cmds_other;            /* '?', '#' y otros */
+    uint32_t loaded;                /* Bytes recibidos por L y U */
+    uint32_t dumped;                /* Bytes recorridos por D */
+    uint16_t rx_lost;               /* Bytes perdidos / desbordes (E R) */
+    uint16_t rx_errors;             /* Bytes fuera de patrón (E R) */
+    uint16_t load_fail;             /* Cargas U incompletas o inválidas */
+    uint16_t runs;                  /* Programas lanzados (G, P, N) */
+    uint16_t returns;               /* Programas que volvieron con RTS */
+    mon_wait_t wait;                /* Esperas de la UART en comandos */
+} mon_stats_t;
+
+static mon_stats_t stats;
+
+/* ============================================
+ * E/S DE LA UART CON CONTABILIDAD DE ESPERAS
+ * ============================================ */
+
+/* Sondeos del comando en curso (monitor_run los pone a cero tras leer la
+ * línea); se suman a stats.wait al acabar */
+static mon_wait_t wait_cmd;
+
+/* Sondeos con la UART lista aún sin sumar a wait_cmd: contar cada byte en
+ * 8 bits sale más barato que en 32 (ver mon_wait_fold) */
+static uint8_t tx_ready_lo;
+static uint8_t rx_ready_lo;
+
+/* Máximo de iteraciones de una espera de TX: un byte de línea completo.
+ * Se calibra solo con las esperas (el banner ya basta) */
+static uint16_t char_loops;
+
+/* Informe de uso tras cada comando (# U) */
+static uint8_t wait_show;
+
+/* Teclas adelantadas: lo que mon_abort saca de la UART sin ser ESC ni
+ * Ctrl-C queda aquí para mon_getc (si se llena, el resto se pierde) */
+#define RX_AHEAD        16
+
+static char rx_ahead[RX_AHEAD];
+static uint8_t rx_head;
+static uint8_t rx_count;
+
+/**
+ * Sondear el registro de estado hasta que 'mask' esté activo o hayan
+ * pasado $FFFF iteraciones. Retorna las iteraciones (unidad de espera)
+ */
+static uint16_t mon_uart_wait(uint8_t mask) {
+    uint16_t n = 0;
+
+    while (!(MON_UART_STATUS & mask) && ++n != 0xFFFF) {
+    }
+    return n;
+}
+
+/**
+ * Sumar a wait_cmd los sondeos con la UART lista pendientes
+ */
+static void mon_wait_fold(void) {
+    wait_cmd.tx_ready += tx_ready_lo;
+    wait_cmd.rx_ready += rx_ready_lo;
+    tx_ready_lo = 0;
+    rx_ready_lo = 0;
+}
+
+static void mon_putc(char c) {
+    uint16_t n;
+
+    if (!(MON_UART_STATUS & MON_UART_TX_READY)) {
+        led_busy_off();
+        n = mon_uart_wait(MON_UART_TX_READY);
+        led_busy_on();
+        wait_cmd.tx_busy += (uint32_t)n + 1;
+        if (n > char_loops) char_loops = n;
+    }
+    if (++tx_ready_lo == 0) wait_cmd.tx_ready += 0x100;
+    led_activity();
+    MON_UART_DATA = c;
+}
+
+static void mon_puts(const char *s) {
+    while (*s) {
+        mon_putc(*s++);
+    }
+}
+
+static char mon_getc(void) {
+    uint16_t n;
+    char c;
+
+    if (rx_count != 0) {
+        c = rx_ahead[rx_head];
+        rx_head = (rx_head + 1) % RX_AHEAD;
+        rx_count--;
+        return c;
+    }
+    if (!mon_uart_rx_ready()) {
+        led_busy_off();
+        while ((n = mon_uart_wait(MON_UART_RX_VALID)) == 0xFFFF) {
+            wait_cmd.rx_busy += n;
+        }
+        wait_cmd.rx_busy += (uint32_t)n + 1;
+        led_busy_on();
+    }
+    if (++rx_ready_lo == 0) wait_cmd.rx_ready += 0x100;
+    led_activity();
+    return MON_UART_DATA;
+}
+
 /* ============================================
  * FUNCIONES DE UTILIDAD - IMPRESIÓN
  * ============================================ */
 
 void mon_newline(void) {
-    uart_putc('\r');
-    uart_putc('\n');
+    mon_putc('\r');
+    mon_putc('\n');
 }
 
 void mon_print_hex8(uint8_t val) {
-    uart_putc(hex_chars[(val >> 4) & 0x0F]);
-    uart_putc(hex_chars[val & 0x0F]);
+    mon_putc(hex_chars[(val >> 4) & 0x0F]);
+    mon_putc(hex_chars[val & 0x0F]);
 }
 
 void mon_print_hex16(uint16_t val) {
@@ -36,26 +247,89 @@ void mon_print_hex16(uint16_t val) {
     mon_print_hex8((uint8_t)(val & 0xFF));
 }
 
+static void mon_print_hex32(uint32_t val) {
+    mon_print_hex16((uint16_t)(val >> 16));
+    mon_print_hex16((uint16_t)val);
+}
+
 static void mon_print_space(void) {
-    uart_putc(' ');
+    mon_putc(' ');
 }
 
 static void mon_prompt(void) {
     mon_newline();
-    uart_putc('>');
+    mon_putc('>');
+}
+
+/**
+ * Imprimir un mensaje de la tabla comprimida: los bytes $80-$FF son
+ * tokens que se expanden a un par de símbolos (literales u otros tokens)
+ */
+static void mon_msg(uint8_t id) {
+    const uint8_t *p = mon_msg_text;
+    uint8_t stack[MSG_DEPTH];
+    uint8_t depth;
+    uint8_t c;
+    
+    /* Saltar los mensajes anteriores (terminados en $00) */
+    while (id > 0) {
+        if (*p++ == 0) id--;
+    }
+    
+    while ((c = *p++) != 0) {
+        stack[0] = c;
+        depth = 1;
+        while (depth > 0) {
+            c = stack[--depth];
+            if (c & 0x80) {
+                c = (c & 0x7F) << 1;
+                stack[depth++] = mon_msg_pairs[c + 1];
+                stack[depth++] = mon_msg_pairs[c];
+            } else {
+                mon_putc(c);
+            }
+        }
+    }
 }
 
-static void mon_error(const char *msg) {
-    uart_puts("ERR: ");
-    uart_puts(msg);
+static void mon_error(uint8_t msg) {
+    mon_puts("ERR: ");
+    mon_msg(msg);
     mon_newline();
 }
 
 static void mon_ok(void) {
-    uart_puts("OK");
+    mon_puts("OK");
     mon_newline();
 }
 
+/**
+ * Sondeo sin bloqueo para abortar comandos largos (una vez por fila o
+ * página): retorna 1 si llegó ESC o Ctrl-C. Las demás teclas se guardan
+ * en rx_ahead para la siguiente línea (tecleo adelantado o pegado).
+ * Al abortar deja last_addr en 'addr' para seguir desde ahí
+ */
+static uint8_t mon_abort(uint16_t addr) {
+    char c;
+    
+    while (1) {
+        if (!mon_uart_rx_ready()) return 0;
+        led_activity();
+        c = uart_getc();
+        if (c == KEY_ESC || c == KEY_CTRL_C) break;
+        if (rx_count < RX_AHEAD) {
+            rx_ahead[(rx_head + rx_count) % RX_AHEAD] = c;
+            rx_count++;
+        }
+    }
+    
+    mon_msg(MSG_ABORTED);
+    mon_print_hex16(addr);
+    mon_newline();
+    last_addr = addr;
+    return 1;
+}
+
 /* ============================================
  * FUNCIONES DE CONVERSIÓN
  * ============================================ */
@@ -120,6 +394,36 @@ static const char* parse_hex_token(const char *str, uint16_t *value) {
     return str;
 }
 
+/**
+ * Parsear siguiente nombre (hasta 'max' caracteres, en mayúsculas)
+ * Retorna longitud del nombre (0 si no hay)
+ */
+static uint8_t parse_name(const char *str, char *name, uint8_t max) {
+    uint8_t n = 0;
+    
+    while (*str == ' ') str++;
+    
+    while (*str != ' ' && *str != '\0') {
+        if (n < max) {
+            name[n++] = (*str >= 'a' && *str <= 'z') ? *str - 32 : *str;
+        }
+        str++;
+    }
+    
+    if (n < max) name[n] = '\0';
+    return n;
+}
+
+/**
+ * Obtener opción de una letra (en mayúscula) tras los parámetros
+ * Retorna '\0' si no hay
+ */
+static char parse_option(const char *str) {
+    while (*str == ' ') str++;
+    if (*str >= 'a' && *str <= 'z') return *str - 32;
+    return *str;
+}
+
 /* ============================================
  * FUNCIONES DE MEMORIA
  * ============================================ */
@@ -132,48 +436,118 @@ void mon_write_byte(uint16_t addr, uint8_t value) {
     *((volatile uint8_t *)addr) = value;
 }
 
-void mon_dump(uint16_t addr, uint16_t len) {
-    uint16_t i;
+/**
+ * Imprimir una fila de dump (hasta 16 bytes, hex + ASCII)
+ */
+static void mon_dump_row(uint16_t row_addr, uint8_t count) {
     uint8_t j;
     uint8_t data[16];
+    
+    /* Imprimir dirección */
+    mon_print_hex16(row_addr);
+    mon_puts(": ");
+    
+    /* Leer y mostrar bytes hex */
+    for (j = 0; j < count; j++) {
+        data[j] = mon_read_byte(row_addr + j);
+        mon_print_hex8(data[j]);
+        mon_print_space();
+    }
+    
+    /* Padding si línea incompleta */
+    while (j < 16) {
+        mon_puts("   ");
+        j++;
+    }
+    
+    /* Mostrar ASCII */
+    mon_putc('|');
+    for (j = 0; j < count; j++) {
+        if (data[j] >= 0x20 && data[j] < 0x7F) {
+            mon_putc(data[j]);
+        } else {
+            mon_putc('.');
+        }
+    }
+    mon_putc('|');
+    mon_newline();
+}
+
+/**
+ * Fila completa de $00 o de $FF
+ */
+static uint8_t mon_row_blank(uint16_t row_addr) {
+    const uint8_t *p = (const uint8_t *)row_addr;
+    uint8_t v = p[0];
+    uint8_t j;
+    
+    if (v != 0x00 && v != 0xFF) return 0;
+    for (j = 1; j < 16; j++) {
+        if (p[j] != v) return 0;
+    }
+    return 1;
+}
+
+void mon_dump_ex(uint16_t addr, uint16_t len, uint8_t mode) {
+    uint16_t i;
     uint16_t row_addr;
+    uint16_t prev_addr = 0;
+    uint16_t dup_addr = 0;
+    uint8_t have_prev = 0;
+    uint8_t in_dup = 0;
+    uint8_t count;
+    uint8_t io;
     
     for (i = 0; i < len; i += 16) {
         row_addr = addr + i;
+        count = (len - i) < 16 ? (uint8_t)(len - i) : 16;
+        /* Toca $C000-$C0FF aunque empiece antes (fila sin alinear en $BFxx) */
+        io = (row_addr <= 0xC0FF && (uint16_t)(row_addr + count - 1) >= 0xC000);
         
-        /* Imprimir dirección */
-        mon_print_hex16(row_addr);
-        uart_puts(": ");
-        
-        /* Leer y mostrar bytes hex */
-        for (j = 0; j < 16 && (i + j) < len; j++) {
-            data[j] = mon_read_byte(row_addr + j);
-            mon_print_hex8(data[j]);
-            mon_print_space();
-        }
-        
-        /* Padding si línea incompleta */
-        while (j < 16) {
-            uart_puts("   ");
-            j++;
-        }
+        if (mon_abort(row_addr)) return;
+        stats.dumped += count;
         
-        /* Mostrar ASCII */
-        uart_putc('|');
-        for (j = 0; j < 16 && (i + j) < len; j++) {
-            if (data[j] >= 0x20 && data[j] < 0x7F) {
-                uart_putc(data[j]);
-            } else {
-                uart_putc('.');
+        /* Solo filas completas fuera de E/S (releer E/S tiene efectos) */
+        if (count == 16 && !io) {
+            /* Tras un hueco, la siguiente fila no se compara con la de
+             * antes del hueco: se imprime */
+            if ((mode & MON_DUMP_SPARSE) && mon_row_blank(row_addr)) {
+                have_prev = 0;
+                continue;
+            }
+            
+            /* Igual a la última fila impresa: colapsar en '*' */
+            if (!(mode & MON_DUMP_ALL) && have_prev &&
+                memcmp((const void *)row_addr, (const void *)prev_addr, 16) == 0) {
+                if (!in_dup) {
+                    mon_putc('*');
+                    mon_newline();
+                    in_dup = 1;
+                }
+                dup_addr = row_addr;
+                continue;
             }
         }
-        uart_putc('|');
-        mon_newline();
+        
+        /* Una fila de E/S no sirve de referencia: compararla la releería */
+        in_dup = 0;
+        have_prev = !io;
+        prev_addr = row_addr;
+        mon_dump_row(row_addr, count);
+    }
+    
+    /* Terminar con la última fila repetida para mostrar el final */
+    if (in_dup) {
+        mon_dump_row(dup_addr, 16);
     }
     
     last_addr = addr + len;
 }
 
+void mon_dump(uint16_t addr, uint16_t len) {
+    mon_dump_ex(addr, len, MON_DUMP_COLLAPSE);
+}
+
 void mon_fill(uint16_t addr, uint16_t len, uint8_t value) {
     uint16_t i;
     for (i = 0; i < len; i++) {
@@ -182,102 +556,508 @@ void mon_fill(uint16_t addr, uint16_t len, uint8_t value) {
 }
 
 /* ============================================
- * EJECUCIÓN DE CÓDIGO
+ * REGISTRO DE REGIONES DE RAM
  * ============================================ */
 
-void mon_execute(uint16_t addr) {
-    code_ptr code = (code_ptr)addr;
-    
-    uart_puts("Ejecutando en $");
-    mon_print_hex16(addr);
-    uart_puts("...");
-    mon_newline();
-    
-    /* Saltar a la dirección */
-    code();
+/* Mapa de memoria del enlazador (mon_map.s): inicio y fin inclusive,
+ * inicio > fin = zona vacía */
+typedef struct {
+    uint16_t start;
+    uint16_t end;
+} mon_span;
+
+#define FREE_ZP         0       /* Zero page libre */
+#define FREE_RAM        1       /* Área RAM del .cfg */
+#define FREE_MONRAM     2       /* MONRAM sin usar */
+#define FREE_COUNT      3
+
+#define OWN_ZP          0       /* Segmento ZEROPAGE */
+#define OWN_MONRAM      1       /* VECRAM + BSS + NOINIT */
+#define OWN_STACK       2       /* Pila C */
+#define OWN_COUNT       3
+
+extern const mon_span mon_map_free[FREE_COUNT];
+extern const mon_span mon_map_own[OWN_COUNT];
+
+#define USER_START      (mon_map_free[FREE_RAM].start)
+#define USER_END        (mon_map_free[FREE_RAM].end)
+#define STACK_START     (mon_map_own[OWN_STACK].start)
+#define STACK_END       (mon_map_own[OWN_STACK].end)
+
+#define MON_NAME_LEN       8
+#define MON_REGIONS_MAX    12
+
+/* Rango de RAM con nombre (vacío si name[0] == 0) */
+typedef struct {
+    char     name[MON_NAME_LEN];
+    uint16_t addr;
+    uint16_t len;
+    uint16_t entry;      /* Punto de entrada (0 = datos) */
+    uint16_t crc;        /* CRC de los primeros crc_len bytes */
+    uint16_t crc_len;
+} mon_region;
+
+/* Firma del bloque de arranque en caliente */
+#define WARM_MAGIC         0x5743   /* "CW" */
+
+/* Tabla y firma en NOINIT: sobreviven a un reset. La tabla vale si
+ * warm_magic es WARM_MAGIC y warm_crc coincide (ver mon_warm_check) */
+#pragma bss-name (push, "NOINIT")
+static mon_region mon_regions[MON_REGIONS_MAX];
+static uint16_t warm_magic;
+static uint16_t warm_crc;
+#pragma bss-name (pop)
+
+/**
+ * CRC-16/CCITT (polinomio $1021, inicial $FFFF) de len bytes, sin tabla
+ */
+static uint16_t mon_crc16(const uint8_t *p, uint16_t len) {
+    uint16_t crc = 0xFFFF;
+    uint8_t x;
     
-    /* Si retorna, mostrar mensaje */
-    mon_newline();
-    uart_puts("Retorno de $");
-    mon_print_hex16(addr);
-    mon_newline();
+    while (len > 0) {
+        x = (uint8_t)(crc >> 8) ^ *p++;
+        x ^= x >> 4;
+        crc = (crc << 8) ^ ((uint16_t)x << 12) ^ ((uint16_t)x << 5) ^ x;
+        len--;
+    }
+    return crc;
 }
 
-/* ============================================
- * MODO CARGA DE BYTES
- * ============================================ */
+/**
+ * Firmar la tabla de regiones tras cada cambio
+ */
+static void mon_warm_seal(void) {
+    warm_magic = WARM_MAGIC;
+    warm_crc = mon_crc16((const uint8_t *)mon_regions, sizeof(mon_regions));
+}
+
+/* Última dirección de una región */
+#define region_end(r)    ((r)->addr + (r)->len - 1)
 
 /**
- * Modo carga: recibe bytes hex separados por espacio
- * Termina con '.' o línea vacía
+ * Buscar un programa residente (región con entrada) por nombre
  */
-static void mon_load_mode(uint16_t addr) {
-    char c;
-    uint8_t byte_val;
-    uint8_t nibble_count = 0;
-    uint16_t bytes_loaded = 0;
+static mon_region* mon_region_find(const char *name) {
+    uint8_t i;
+    for (i = 0; i < MON_REGIONS_MAX; i++) {
+        if (mon_regions[i].name[0] && mon_regions[i].entry &&
+            strncmp(mon_regions[i].name, name, MON_NAME_LEN) == 0) {
+            return &mon_regions[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * Liberar todas las regiones que solapan [start, end]
+ */
+static void mon_region_drop(uint16_t start, uint16_t end) {
+    uint8_t i;
+    for (i = 0; i < MON_REGIONS_MAX; i++) {
+        if (mon_regions[i].name[0] &&
+            mon_regions[i].addr <= end && start <= region_end(&mon_regions[i])) {
+            mon_regions[i].name[0] = 0;
+        }
+    }
+    mon_warm_seal();
+}
+
+uint8_t mon_region_add(const char *name, uint16_t addr, uint16_t len, uint16_t entry) {
+    mon_region *r;
+    uint8_t i;
     
-    uart_puts("Modo carga en $");
-    mon_print_hex16(addr);
-    uart_puts(" (terminar con '.')");
-    mon_newline();
-    uart_putc(':');
+    if (len == 0 || name[0] == '\0') return MON_ERROR;
     
-    byte_val = 0;
+    /* Lo que había debajo queda sobrescrito; un programa nuevo
+       sustituye además al del mismo nombre cargado en otro sitio */
+    mon_region_drop(addr, addr + len - 1);
+    if (entry) {
+        r = mon_region_find(name);
+        if (r) r->name[0] = 0;
+    }
     
-    while (1) {
-        c = uart_getc();
-        
-        /* Terminar con punto */
-        if (c == '.') {
-            break;
+    for (i = 0; i < MON_REGIONS_MAX; i++) {
+        r = &mon_regions[i];
+        if (!r->name[0]) {
+            strncpy(r->name, name, MON_NAME_LEN);
+            r->addr = addr;
+            r->len = len;
+            r->entry = entry;
+            r->crc_len = len;
+            r->crc = mon_crc16((const uint8_t *)addr, len);
+            mon_warm_seal();
+            return MON_OK;
         }
-        
-        /* Enter - nueva línea de entrada */
-        if (c == '\r' || c == '\n') {
-            mon_newline();
-            uart_putc(':');
-            continue;
+    }
+    return MON_ERROR;
+}
+
+/**
+ * Anotar lo que F o L han escrito en [start, end]: registrar 'name' (o,
+ * con name == 0, liberar lo que solape) solo en los tramos de zonas
+ * libres; ROM, E/S y RAM del monitor no se anotan
+ */
+static void mon_region_mark(const char *name, uint16_t start, uint16_t end) {
+    const mon_span *z;
+    uint16_t a, b;
+    uint8_t i;
+    
+    for (i = 0; i < FREE_COUNT; i++) {
+        z = &mon_map_free[i];
+        if (z->start > z->end || z->end < start || z->start > end) continue;
+        a = z->start > start ? z->start : start;
+        b = z->end < end ? z->end : end;
+        if (name) {
+            mon_region_add(name, a, b - a + 1, 0);
+        } else {
+            mon_region_drop(a, b);
         }
-        
-        /* Espacio - separador */
-        if (c == ' ') {
-            uart_putc(' ');
-            continue;
+    }
+}
+
+uint8_t mon_region_free(uint16_t addr) {
+    uint8_t i;
+    for (i = 0; i < MON_REGIONS_MAX; i++) {
+        if (mon_regions[i].name[0] &&
+            mon_regions[i].addr <= addr && addr <= region_end(&mon_regions[i])) {
+            mon_regions[i].name[0] = 0;
+            mon_warm_seal();
+            return MON_OK;
         }
-        
-        /* Procesar hex */
-        if (is_hex_char(c)) {
-            uart_putc(c); /* Echo */
-            byte_val = (byte_val << 4) | hex_char_to_val(c);
-            nibble_count++;
-            
-            if (nibble_count == 2) {
-                /* Byte completo - escribir */
-                mon_write_byte(addr, byte_val);
-                addr++;
-                bytes_loaded++;
-                byte_val = 0;
-                nibble_count = 0;
-            }
+    }
+    return MON_ERROR;
+}
+
+/**
+ * Limitar el CRC de la región que empieza en addr a sus primeros len
+ * bytes (el código, sin la zona de datos que el programa modifica)
+ */
+static void mon_region_crc(uint16_t addr, uint16_t len) {
+    uint8_t i;
+    for (i = 0; i < MON_REGIONS_MAX; i++) {
+        if (mon_regions[i].name[0] && mon_regions[i].addr == addr) {
+            mon_regions[i].crc_len = len;
+            mon_regions[i].crc = mon_crc16((const uint8_t *)addr, len);
+            mon_warm_seal();
+            return;
         }
     }
+}
+
+/**
+ * Validar el bloque de arranque en caliente tras un reset: firma y CRC
+ * de la tabla, y el CRC de cada región (las que cambiaron se descartan)
+ * Retorna 1 si la tabla era válida
+ */
+static uint8_t mon_warm_check(void) {
+    mon_region *r;
+    uint8_t i;
     
-    mon_newline();
-    uart_puts("Cargados ");
-    mon_print_hex16(bytes_loaded);
-    uart_puts(" bytes");
-    mon_newline();
+    warm_kept = 0;
+    warm_dropped = 0;
+    if (warm_magic != WARM_MAGIC ||
+        warm_crc != mon_crc16((const uint8_t *)mon_regions, sizeof(mon_regions))) {
+        return 0;
+    }
     
-    last_addr = addr;
+    for (i = 0; i < MON_REGIONS_MAX; i++) {
+        r = &mon_regions[i];
+        if (!r->name[0]) continue;
+        if (mon_crc16((const uint8_t *)r->addr, r->crc_len) == r->crc) {
+            warm_kept++;
+        } else {
+            r->name[0] = 0;
+            warm_dropped++;
+        }
+    }
+    mon_warm_seal();
+    return 1;
 }
 
-/* ============================================
- * DESENSAMBLADOR BÁSICO
- * ============================================ */
+/**
+ * Clasificar el tramo que empieza en addr (sin pasar de end)
+ * Retorna la región que lo cubre, o 0 si no está registrado; en
+ * *span_end deja el último byte del tramo (fin de la región o byte
+ * anterior a la siguiente región)
+ */
+static const mon_region* mon_region_span(uint16_t addr, uint16_t end, uint16_t *span_end) {
+    const mon_region *r;
+    uint8_t i;
+    
+    *span_end = end;
+    for (i = 0; i < MON_REGIONS_MAX; i++) {
+        r = &mon_regions[i];
+        if (!r->name[0]) continue;
+        if (r->addr <= addr && addr <= region_end(r)) {
+            if (region_end(r) < end) *span_end = region_end(r);
+            return r;
+        }
+        if (r->addr > addr && r->addr - 1 < *span_end) {
+            *span_end = r->addr - 1;
+        }
+    }
+    return 0;
+}
 
-/* Tabla simplificada de mnemonics (solo instrucciones comunes) */
-static const char* get_mnemonic(uint8_t opcode) {
+/**
+ * Imprimir un nombre de región (relleno hasta MON_NAME_LEN)
+ */
+static void mon_print_name(const char *name) {
+    uint8_t j;
+    for (j = 0; j < MON_NAME_LEN; j++) {
+        mon_putc(name[j] ? name[j] : ' ');
+    }
+}
+
+/**
+ * Listar regiones registradas (solo programas si 'progs')
+ * Retorna el total de bytes listados
+ */
+static uint16_t mon_region_list(uint8_t progs) {
+    const mon_region *r;
+    uint8_t i;
+    uint16_t total = 0;
+    
+    for (i = 0; i < MON_REGIONS_MAX; i++) {
+        r = &mon_regions[i];
+        if (!r->name[0] || (progs && !r->entry)) continue;
+        total += r->len;
+        mon_puts("  ");
+        mon_print_name(r->name);
+        mon_puts(" $");
+        mon_print_hex16(r->addr);
+        mon_puts("-$");
+        mon_print_hex16(region_end(r));
+        if (r->entry) {
+            mon_puts(" G $");
+            mon_print_hex16(r->entry);
+        }
+        mon_newline();
+    }
+    if (total == 0) {
+        mon_msg(progs ? MSG_NO_RESIDENT : MSG_NO_REGIONS);
+    }
+    return total;
+}
+
+/* ============================================
+ * PROGRAMAS EN ROM (BUNDLE)
+ * ============================================ */
+
+/* Trailer escrito por bin2rom3.py: 'P','B', dirección del directorio */
+#define BUNDLE_TRAILER   0x9FF6
+#define BUNDLE_NAME_LEN  8
+#define BUNDLE_RLE       0x01
+#define BUNDLE_XIP       0x02
+
+/* Entrada de directorio (17 bytes, little-endian) */
+typedef struct {
+    char     name[BUNDLE_NAME_LEN];
+    uint16_t src;        /* Imagen en ROM */
+    uint16_t stored;     /* Bytes almacenados */
+    uint16_t load;       /* Dirección de carga/ejecución */
+    uint16_t len;        /* Bytes descomprimidos */
+    uint8_t  flags;
+} bundle_entry;
+
+/**
+ * Localizar el directorio de programas en ROM
+ * Retorna número de entradas (0 si la ROM no tiene bundle)
+ */
+static uint8_t bundle_open(const bundle_entry **dir) {
+    const uint8_t *t = (const uint8_t *)BUNDLE_TRAILER;
+    const uint8_t *p;
+    
+    if (t[0] != 'P' || t[1] != 'B') return 0;
+    
+    p = (const uint8_t *)(t[2] | ((uint16_t)t[3] << 8));
+    *dir = (const bundle_entry *)(p + 1);
+    return p[0];
+}
+
+/**
+ * Descomprimir imagen RLE (ver rle_compress en bin2rom3.py)
+ */
+static void bundle_unpack(const uint8_t *src, uint8_t *dst, uint16_t len) {
+    uint8_t c, n, val;
+    
+    while (len > 0) {
+        c = *src++;
+        if (c & 0x80) {
+            /* Repetición */
+            n = (c & 0x7F) + 3;
+            val = *src++;
+            while (n > 0 && len > 0) {
+                *dst++ = val;
+                n--;
+                len--;
+            }
+        } else {
+            /* Literales */
+            n = c + 1;
+            while (n > 0 && len > 0) {
+                *dst++ = *src++;
+                n--;
+                len--;
+            }
+        }
+    }
+}
+
+/**
+ * Listar los programas del bundle
+ */
+static void mon_bundle_list(void) {
+    const bundle_entry *e;
+    uint8_t count, i, j;
+    
+    count = bundle_open(&e);
+    if (count == 0) {
+        mon_msg(MSG_NO_BUNDLES);
+        return;
+    }
+    
+    for (i = 0; i < count; i++, e++) {
+        mon_puts("  ");
+        for (j = 0; j < BUNDLE_NAME_LEN; j++) {
+            mon_putc(e->name[j] ? e->name[j] : ' ');
+        }
+        mon_puts(" $");
+        mon_print_hex16(e->src);
+        mon_print_space();
+        mon_print_hex16(e->len);
+        if (e->flags & BUNDLE_XIP) {
+            mon_puts(" XIP");
+        } else {
+            mon_puts(" -> $");
+            mon_print_hex16(e->load);
+            if (e->flags & BUNDLE_RLE) mon_puts(" RLE");
+        }
+        mon_newline();
+    }
+}
+
+/**
+ * Copiar (o descomprimir) un programa del bundle y ejecutarlo
+ */
+static void mon_bundle_run(const char *name) {
+    const bundle_entry *e;
+    uint8_t count;
+    
+    count = bundle_open(&e);
+    for (; count > 0; count--, e++) {
+        if (strncmp(e->name, name, BUNDLE_NAME_LEN) != 0) continue;
+        
+        if (e->flags & BUNDLE_XIP) {
+            mon_execute(e->src);
+        } else {
+            if (e->flags & BUNDLE_RLE) {
+                bundle_unpack((const uint8_t *)e->src, (uint8_t *)e->load, e->len);
+            } else {
+                memcpy((void *)e->load, (const void *)e->src, e->len);
+            }
+            mon_region_add(e->name, e->load, e->len, e->load);
+            last_addr = e->load + e->len;
+            mon_execute(e->load);
+        }
+        return;
+    }
+    
+    mon_error(MSG_E_NOT_FOUND);
+}
+
+/* ============================================
+ * MODO CARGA DE BYTES
+ * ============================================ */
+
+/**
+ * Recibir el siguiente byte hex por UART (con eco)
+ * Ignora espacios y saltos de línea; Enter muestra un nuevo ':'
+ * Retorna 0 si se recibió '.' (fin de carga)
+ */
+static uint8_t mon_recv_hex(uint8_t *out) {
+    char c;
+    uint8_t byte_val = 0;
+    uint8_t nibble_count = 0;
+    
+    while (1) {
+        c = mon_getc();
+        
+        /* Terminar con punto */
+        if (c == '.') {
+            return 0;
+        }
+        
+        /* Enter - nueva línea de entrada */
+        if (c == '\r' || c == '\n') {
+            mon_newline();
+            mon_putc(':');
+            continue;
+        }
+        
+        /* Espacio - separador */
+        if (c == ' ') {
+            mon_putc(' ');
+            continue;
+        }
+        
+        /* Procesar hex */
+        if (is_hex_char(c)) {
+            mon_putc(c); /* Echo */
+            byte_val = (byte_val << 4) | hex_char_to_val(c);
+            nibble_count++;
+            
+            if (nibble_count == 2) {
+                *out = byte_val;
+                return 1;
+            }
+        }
+    }
+}
+
+/**
+ * Modo carga: recibe bytes hex separados por espacio
+ * Termina con '.' o línea vacía
+ */
+static void mon_load_mode(uint16_t addr) {
+    uint8_t byte_val;
+    uint16_t start = addr;
+    uint16_t bytes_loaded = 0;
+    
+    mon_msg(MSG_LOAD_AT);
+    mon_print_hex16(addr);
+    mon_msg(MSG_LOAD_END);
+    mon_putc(':');
+    
+    while (mon_recv_hex(&byte_val)) {
+        /* Byte completo - escribir */
+        mon_write_byte(addr, byte_val);
+        addr++;
+        bytes_loaded++;
+    }
+    
+    stats.loaded += bytes_loaded;
+    
+    mon_newline();
+    mon_msg(MSG_LOADED);
+    mon_print_hex16(bytes_loaded);
+    mon_puts(" bytes");
+    mon_newline();
+    
+    if (bytes_loaded != 0) {
+        mon_region_mark("CARGA", start, (bytes_loaded - 1 > 0xFFFF - start) ?
+                        0xFFFF : start + bytes_loaded - 1);
+    }
+    last_addr = addr;
+}
+
+/* ============================================
+ * DESENSAMBLADOR BÁSICO
+ * ============================================ */
+
+/* Tabla simplificada de mnemonics (solo instrucciones comunes) */
+static const char* get_mnemonic(uint8_t opcode) {
     switch (opcode) {
         case 0x00: return "BRK";
         case 0x20: return "JSR";
@@ -335,38 +1115,19 @@ static const char* get_mnemonic(uint8_t opcode) {
     }
 }
 
-/* Bytes por instrucción (simplificado) */
+/* Bytes por instrucción (por modo de direccionamiento: bits 2-4 y 0-1) */
 static uint8_t get_instruction_len(uint8_t opcode) {
-    /* Implied/Accumulator - 1 byte */
-    if (opcode == 0x00 || opcode == 0x40 || opcode == 0x60 ||
-        opcode == 0xE8 || opcode == 0xC8 || opcode == 0xCA ||
-        opcode == 0x88 || opcode == 0x18 || opcode == 0x38 ||
-        opcode == 0xD8 || opcode == 0xF8 || opcode == 0x58 ||
-        opcode == 0x78 || opcode == 0xEA || opcode == 0xAA ||
-        opcode == 0xA8 || opcode == 0x8A || opcode == 0x98 ||
-        opcode == 0x9A || opcode == 0xBA || opcode == 0x48 ||
-        opcode == 0x68 || opcode == 0x08 || opcode == 0x28) {
-        return 1;
-    }
-    
-    /* Immediate, Zero Page, Relative - 2 bytes */
-    if ((opcode & 0x0F) == 0x09 || /* Immediate */
-        (opcode & 0x0F) == 0x05 || /* Zero Page */
-        (opcode & 0x0F) == 0x06 || /* Zero Page */
-        (opcode & 0x1F) == 0x10 || /* Branches */
-        opcode == 0xA2 || opcode == 0xA0 ||
-        opcode == 0xE0 || opcode == 0xC0) {
-        return 2;
-    }
-    
-    /* Absolute, Indirect - 3 bytes */
-    if (opcode == 0x20 || opcode == 0x4C || opcode == 0x6C ||
-        (opcode & 0x0F) == 0x0D || /* Absolute */
-        (opcode & 0x0F) == 0x0E) {
-        return 3;
-    }
-    
-    /* Por defecto asumir 2 bytes */
+    uint8_t mode = (opcode >> 2) & 0x07;
+    
+    if (mode == 3 || mode == 7) return 3;               /* Absolutos */
+    if ((opcode & 0x03) == 0x01) {                      /* Grupo ALU */
+        return (mode == 6) ? 3 : 2;                     /* abs,Y o 2 bytes */
+    }
+    if (mode == 2 || mode == 6) return 1;               /* Implícito/acumulador */
+    if (opcode == 0x20) return 3;                       /* JSR */
+    if (opcode == 0x00 || opcode == 0x40 || opcode == 0x60) {
+        return 1;                                       /* BRK, RTI, RTS */
+    }
     return 2;
 }
 
@@ -376,6 +1137,8 @@ static void mon_disassemble(uint16_t addr, uint8_t lines) {
     uint8_t bytes[3];
     
     for (i = 0; i < lines; i++) {
+        if (mon_abort(addr)) return;
+        
         opcode = mon_read_byte(addr);
         len = get_instruction_len(opcode);
         
@@ -386,27 +1149,27 @@ static void mon_disassemble(uint16_t addr, uint8_t lines) {
         
         /* Imprimir dirección */
         mon_print_hex16(addr);
-        uart_puts("  ");
+        mon_puts("  ");
         
         /* Imprimir bytes hex */
         for (j = 0; j < 3; j++) {
             if (j < len) {
                 mon_print_hex8(bytes[j]);
             } else {
-                uart_puts("  ");
+                mon_puts("  ");
             }
             mon_print_space();
         }
         
         /* Imprimir mnemonic */
-        uart_puts(get_mnemonic(opcode));
+        mon_puts(get_mnemonic(opcode));
         
         /* Imprimir operando si hay */
         if (len == 2) {
-            uart_puts(" $");
+            mon_puts(" $");
             mon_print_hex8(bytes[1]);
         } else if (len == 3) {
-            uart_puts(" $");
+            mon_puts(" $");
             mon_print_hex8(bytes[2]);
             mon_print_hex8(bytes[1]);
         }
@@ -422,17 +1185,16 @@ static void mon_disassemble(uint16_t addr, uint8_t lines) {
  * ANÁLISIS DE MEMORIA RAM
  * ============================================ */
 
-/* Constantes del mapa de memoria */
-#define RAM_START       0x0100
-#define RAM_END         0x3DFF
-#define ZP_START        0x0002
-#define ZP_END          0x00FF
-#define STACK_START     0x3E00
-#define STACK_END       0x3FFF
-#define ROM_START       0x8000
-#define ROM_END         0x9FFF
-#define IO_START        0xC000
-#define IO_END          0xC0FF
+/* Páginas que muestra V (toda la RAM física salvo la zero page) */
+#define VIEW_FIRST_PAGE 0x01
+#define VIEW_LAST_PAGE  0x3F
+
+static const char * const free_names[FREE_COUNT] = {
+    "  ZP:     ", "  RAM:    ", "  RAM mon:"
+};
+static const char * const own_names[OWN_COUNT] = {
+    "  ZP:     ", "  RAM:    ", "  Pila C: "
+};
 
 /**
  * Imprimir número decimal (hasta 65535)
@@ -442,7 +1204,7 @@ static void mon_print_dec(uint16_t val) {
     uint8_t i = 0;
     
     if (val == 0) {
-        uart_putc('0');
+        mon_putc('0');
         return;
     }
     
@@ -452,322 +1214,1684 @@ static void mon_print_dec(uint16_t val) {
     }
     
     while (i > 0) {
-        uart_putc(buf[--i]);
+        mon_putc(buf[--i]);
     }
 }
 
 /**
- * Mostrar información del sistema (mapa de memoria)
+ * Imprimir un bloque "  etiqueta $inicio-$fin (n bytes)"
  */
-static void mon_info(void) {
-    mon_newline();
-    uart_puts("=== MAPA DE MEMORIA ===");
-    mon_newline();
-    mon_newline();
-    
-    uart_puts("Zero Page:  $0002-$00FF (");
-    mon_print_dec(ZP_END - ZP_START + 1);
-    uart_puts(" bytes)");
-    mon_newline();
-    
-    uart_puts("RAM:        $0100-$3DFF (");
-    mon_print_dec(RAM_END - RAM_START + 1);
-    uart_puts(" bytes)");
+static void mon_print_block(const char *label, uint16_t start, uint16_t end) {
+    mon_puts(label);
+    mon_puts(" $");
+    mon_print_hex16(start);
+    mon_puts("-$");
+    mon_print_hex16(end);
+    mon_puts(" (");
+    mon_print_dec(end - start + 1);
+    mon_puts(" bytes)");
     mon_newline();
+}
+
+/**
+ * Imprimir una zona del mapa (nada si está vacía)
+ */
+static void mon_span_line(const char *label, const mon_span *z) {
+    if (z->start <= z->end) mon_print_block(label, z->start, z->end);
+}
+
+/**
+ * Dirección fuera de lo que usa el monitor (zonas libres del mapa)
+ */
+static uint8_t mon_is_free(uint16_t addr) {
+    uint8_t i;
     
-    uart_puts("Stack:      $3E00-$3FFF (");
-    mon_print_dec(STACK_END - STACK_START + 1);
-    uart_puts(" bytes)");
-    mon_newline();
+    for (i = 0; i < FREE_COUNT; i++) {
+        if (mon_map_free[i].start <= addr && addr <= mon_map_free[i].end) return 1;
+    }
+    return 0;
+}
+
+/**
+ * Recorrer con 'fn' los tramos de [start, end] que caen en zonas libres
+ * del mapa; lo que usa el monitor (ZP del runtime, BSS, pila C...) se
+ * salta. 'fn' retorna 1 si se abortó. Sin ningún tramo: ERR
+ */
+static void mon_free_each(uint16_t start, uint16_t end, uint8_t (*fn)(uint16_t, uint16_t)) {
+    const mon_span *z;
+    uint16_t a, b;
+    uint8_t i;
+    uint8_t any = 0;
     
-    uart_puts("ROM:        $8000-$9FFF (~8 KB)");
-    mon_newline();
+    for (i = 0; i < FREE_COUNT; i++) {
+        z = &mon_map_free[i];
+        if (z->start > z->end || z->end < start || z->start > end) continue;
+        a = z->start > start ? z->start : start;
+        b = z->end < end ? z->end : end;
+        any = 1;
+        if (fn(a, b)) return;
+    }
+    if (!any) mon_error(MSG_E_NO_RAM);
+}
+
+/**
+ * Bytes de regiones registradas dentro de [start, end] (las regiones
+ * no se solapan entre sí: mon_region_add quita lo que pisa)
+ */
+static uint16_t mon_region_bytes(uint16_t start, uint16_t end) {
+    const mon_region *r;
+    uint16_t a, b;
+    uint16_t total = 0;
+    uint8_t i;
     
-    uart_puts("I/O:        $C000-$C0FF");
-    mon_newline();
-    mon_newline();
+    for (i = 0; i < MON_REGIONS_MAX; i++) {
+        r = &mon_regions[i];
+        if (!r->name[0]) continue;
+        a = r->addr > start ? r->addr : start;
+        b = region_end(r) < end ? region_end(r) : end;
+        if (a <= b) total += b - a + 1;
+    }
+    return total;
+}
+
+/**
+ * Mostrar información del sistema (mapa de memoria)
+ */
+static void mon_info(void) {
+    const mon_span *z;
+    uint16_t unreg = 0;
+    uint8_t i;
     
-    uart_puts("RAM libre para programas:");
+    mon_msg(MSG_INFO);
+    for (i = 0; i < OWN_COUNT; i++) {
+        mon_span_line(own_names[i], &mon_map_own[i]);
+    }
     mon_newline();
-    uart_puts("  $0200-$3DFF (");
-    mon_print_dec(0x3DFF - 0x0200 + 1);
-    uart_puts(" bytes)");
+    mon_msg(MSG_INFO_FREE);
+    for (i = 0; i < FREE_COUNT; i++) {
+        mon_span_line(free_names[i], &mon_map_free[i]);
+    }
     mon_newline();
+    mon_msg(MSG_INFO_REGS);
+    mon_region_list(0);
+    for (i = 0; i < FREE_COUNT; i++) {
+        z = &mon_map_free[i];
+        if (z->start > z->end) continue;
+        unreg += z->end - z->start + 1 - mon_region_bytes(z->start, z->end);
+    }
+    mon_msg(MSG_INFO_UNREG);
+    mon_print_dec(unreg);
+    mon_msg(MSG_INFO_UNREG_END);
 }
 
 /**
  * Escanear rango de memoria y contar bytes "libres" (00 o FF)
- * Muestra estadísticas y bloques libres
+ * Las regiones registradas cuentan como usadas sin leerlas; el
+ * criterio $00/$FF solo se aplica al espacio sin registrar.
+ * Retorna 1 si se abortó
  */
-static void mon_scan(uint16_t start, uint16_t end) {
+static uint8_t mon_scan(uint16_t start, uint16_t end) {
     uint16_t addr;
+    uint16_t span_end;
     uint16_t free_00 = 0;
     uint16_t free_ff = 0;
     uint16_t used = 0;
+    uint16_t reg = 0;
     uint8_t val;
     uint16_t block_start = 0;
     uint8_t in_free_block = 0;
     uint8_t blocks_shown = 0;
+    const mon_region *r;
     
-    uart_puts("Escaneando $");
+    mon_msg(MSG_SCAN_AT);
     mon_print_hex16(start);
-    uart_puts("-$");
+    mon_puts("-$");
     mon_print_hex16(end);
-    uart_puts("...");
+    mon_puts("...");
     mon_newline();
     
-    for (addr = start; addr <= end; addr++) {
-        val = mon_read_byte(addr);
+    addr = start;
+    while (1) {
+        r = mon_region_span(addr, end, &span_end);
         
-        if (val == 0x00) {
-            free_00++;
-            if (!in_free_block) {
-                in_free_block = 1;
-                block_start = addr;
-            }
-        } else if (val == 0xFF) {
-            free_ff++;
-            if (!in_free_block) {
-                in_free_block = 1;
-                block_start = addr;
+        if (mon_abort(addr)) return 1;
+        
+        if (r) {
+            /* Región registrada: cierra el bloque libre en curso */
+            if (in_free_block && (addr - block_start) >= 16 && blocks_shown < 8) {
+                mon_print_block("  Libre:", block_start, addr - 1);
+                blocks_shown++;
             }
+            in_free_block = 0;
+            reg += span_end - addr + 1;
+            mon_puts("  ");
+            mon_print_name(r->name);
+            mon_print_block(":", addr, span_end);
         } else {
-            used++;
-            /* Fin de bloque libre */
-            if (in_free_block && (addr - block_start) >= 16) {
-                if (blocks_shown < 8) { /* Limitar a 8 bloques */
-                    uart_puts("  Libre: $");
-                    mon_print_hex16(block_start);
-                    uart_puts("-$");
-                    mon_print_hex16(addr - 1);
-                    uart_puts(" (");
-                    mon_print_dec(addr - block_start);
-                    uart_puts(" bytes)");
-                    mon_newline();
-                    blocks_shown++;
+            for (; ; addr++) {
+                if ((addr & 0xFF) == 0 && mon_abort(addr)) return 1;
+                
+                val = mon_read_byte(addr);
+                
+                if (val == 0x00 || val == 0xFF) {
+                    if (val == 0x00) free_00++; else free_ff++;
+                    if (!in_free_block) {
+                        in_free_block = 1;
+                        block_start = addr;
+                    }
+                } else {
+                    used++;
+                    /* Fin de bloque libre */
+                    if (in_free_block && (addr - block_start) >= 16 && blocks_shown < 8) {
+                        mon_print_block("  Libre:", block_start, addr - 1);
+                        blocks_shown++;
+                    }
+                    in_free_block = 0;
                 }
+                
+                if (addr == span_end) break;
             }
-            in_free_block = 0;
         }
         
         /* Evitar overflow */
-        if (addr == 0xFFFF) break;
+        if (span_end >= end || span_end == 0xFFFF) break;
+        addr = span_end + 1;
     }
     
     /* Último bloque */
     if (in_free_block && (end - block_start + 1) >= 16 && blocks_shown < 8) {
-        uart_puts("  Libre: $");
-        mon_print_hex16(block_start);
-        uart_puts("-$");
-        mon_print_hex16(end);
-        uart_puts(" (");
-        mon_print_dec(end - block_start + 1);
-        uart_puts(" bytes)");
-        mon_newline();
+        mon_print_block("  Libre:", block_start, end);
     }
     
     mon_newline();
-    uart_puts("Resultados:");
-    mon_newline();
-    uart_puts("  Bytes $00: ");
+    mon_msg(MSG_SCAN_RESULTS);
+    mon_msg(MSG_SCAN_00);
     mon_print_dec(free_00);
     mon_newline();
-    uart_puts("  Bytes $FF: ");
+    mon_msg(MSG_SCAN_FF);
     mon_print_dec(free_ff);
     mon_newline();
-    uart_puts("  Bytes usados: ");
+    mon_msg(MSG_SCAN_USED);
     mon_print_dec(used);
     mon_newline();
-    uart_puts("  Total libre: ");
+    mon_msg(MSG_SCAN_REG);
+    mon_print_dec(reg);
+    mon_newline();
+    mon_msg(MSG_SCAN_TOTAL);
     mon_print_dec(free_00 + free_ff);
-    uart_puts(" / ");
+    mon_puts(" / ");
     mon_print_dec(end - start + 1);
     mon_newline();
+    return 0;
+}
+
+/**
+ * Buscar un bloque libre de 'size' bytes que empiece en frontera de
+ * página: fuera de las regiones registradas y con bytes $00/$FF
+ * (mismo criterio que mon_scan)
+ * Retorna su dirección o 0 si no hay
+ */
+static uint16_t mon_find_free(uint16_t start, uint16_t end, uint16_t size) {
+    uint16_t addr;
+    uint16_t span_end;
+    uint16_t block_start = 0;
+    uint8_t in_free_block = 0;
+    uint8_t val;
+    
+    addr = start;
+    while (1) {
+        if (mon_region_span(addr, end, &span_end)) {
+            in_free_block = 0;
+        } else {
+            for (; ; addr++) {
+                val = mon_read_byte(addr);
+                
+                if (val == 0x00 || val == 0xFF) {
+                    if (!in_free_block) {
+                        in_free_block = 1;
+                        block_start = (addr + 0xFF) & 0xFF00;
+                    }
+                    if (addr >= block_start && addr - block_start + 1 >= size) {
+                        return block_start;
+                    }
+                } else {
+                    in_free_block = 0;
+                }
+                
+                if (addr == span_end) break;
+            }
+        }
+        
+        /* Evitar overflow */
+        if (span_end >= end || span_end == 0xFFFF) break;
+        addr = span_end + 1;
+    }
+    
+    return 0;
+}
+
+/**
+ * Prueba de RAM: escribir y leer para verificar que funciona
+ * Usa un test simple: escribe valor, lee, verifica.
+ * Retorna 1 si se abortó
+ */
+static uint8_t mon_test_ram(uint16_t start, uint16_t end) {
+    uint16_t len = end - start + 1;
+    uint16_t i;
+    uint16_t addr;
+    uint8_t original;
+    uint8_t test_val;
+    uint8_t read_val;
+    uint16_t errors = 0;
+    uint16_t ok = 0;
+    
+    mon_msg(MSG_TEST_AT);
+    mon_print_hex16(start);
+    mon_puts("-$");
+    mon_print_hex16(end);
+    mon_newline();
+    
+    for (i = 0; i < len; i++) {
+        addr = start + i;
+        
+        /* Abortar entre bytes: el byte en curso siempre se restaura */
+        if ((i & 0xFF) == 0 && i != 0 && mon_abort(addr)) return 1;
+        
+        /* Guardar valor original */
+        original = mon_read_byte(addr);
+        
+        /* Test 1: escribir $55 */
+        test_val = 0x55;
+        mon_write_byte(addr, test_val);
+        read_val = mon_read_byte(addr);
+        
+        if (read_val != test_val) {
+            errors++;
+            if (errors <= 5) {
+                mon_puts("  $");
+                mon_print_hex16(addr);
+                mon_puts(" W:");
+                mon_print_hex8(test_val);
+                mon_puts(" R:");
+                mon_print_hex8(read_val);
+                mon_newline();
+            }
+        } else {
+            /* Test 2: escribir $AA (complemento) */
+            test_val = 0xAA;
+            mon_write_byte(addr, test_val);
+            read_val = mon_read_byte(addr);
+            
+            if (read_val != test_val) {
+                errors++;
+                if (errors <= 5) {
+                    mon_puts("  $");
+                    mon_print_hex16(addr);
+                    mon_puts(" W:");
+                    mon_print_hex8(test_val);
+                    mon_puts(" R:");
+                    mon_print_hex8(read_val);
+                    mon_newline();
+                }
+            } else {
+                ok++;
+            }
+        }
+        
+        /* Restaurar valor original */
+        mon_write_byte(addr, original);
+    }
+    
+    mon_newline();
+    if (errors == 0) {
+        mon_puts("OK: ");
+        mon_print_dec(ok);
+        mon_puts(" bytes");
+    } else {
+        mon_puts("FAIL: ");
+        mon_print_dec(errors);
+        mon_puts("/");
+        mon_print_dec(len);
+    }
+    mon_newline();
+    return 0;
+}
+
+/**
+ * Vista rápida de uso de memoria (mapa visual)
+ */
+static void mon_memmap(void) {
+    uint16_t page;
+    uint16_t addr;
+    uint16_t span_end = 0;
+    uint8_t used_count;
+    uint8_t reg_count;
+    uint8_t own_count;
+    uint8_t i;
+    uint8_t in_reg = 0;
+    char symbol;
+    
+    mon_msg(MSG_VIEW_HEAD);
+    
+    for (page = VIEW_FIRST_PAGE; page <= VIEW_LAST_PAGE; page++) {
+        if ((page & 0x0F) == 0x01) {
+            mon_puts("$");
+            mon_print_hex8((uint8_t)page);
+            mon_puts(": ");
+        }
+        
+        /* Contar bytes usados en la página (registrados sin leer; lo
+         * del monitor ni se lee) */
+        used_count = 0;
+        reg_count = 0;
+        own_count = 0;
+        for (i = 0; i < 64; i++) { /* Muestrear cada 4 bytes */
+            addr = (page << 8) | (i << 2);
+            if (addr > span_end) {
+                in_reg = (mon_region_span(addr, VIEW_LAST_PAGE * 0x100 + 0xFF, &span_end) != 0);
+            }
+            if (!mon_is_free(addr)) {
+                own_count++;
+            } else if (in_reg) {
+                reg_count++;
+            } else if (mon_read_byte(addr) != 0x00 && mon_read_byte(addr) != 0xFF) {
+                used_count++;
+            }
+        }
+        
+        /* Determinar símbolo sobre las muestras libres */
+        if (own_count == 64) {
+            symbol = 'M';
+        } else if (reg_count == 64 - own_count) {
+            symbol = 'R';
+        } else if (used_count + reg_count == 0) {
+            symbol = '.';
+        } else if (used_count + reg_count >= 60 - own_count) {
+            symbol = '#';
+        } else {
+            symbol = 'X';
+        }
+        
+        mon_putc(symbol);
+        
+        if ((page & 0x0F) == 0x00 || page == VIEW_LAST_PAGE) {
+            mon_newline();
+        }
+    }
+    
+    mon_newline();
+    mon_msg(MSG_VIEW_FOOT);
+}
+
+/**
+ * Informe de G addr P: pico de pila HW, pico de pila C y bytes de
+ * zero page libre que el programa modificó
+ */
+static void mon_probe_report(void) {
+    uint16_t zp;
+    uint8_t run_start = 0;
+    uint8_t in_run = 0;
+    uint8_t any = 0;
+    
+    mon_msg(MSG_PROBE_HW);
+    mon_print_dec(mon_probe_s + 1 - mon_probe_hw_low);
+    mon_msg(MSG_PROBE_PEAK_HW);
+    mon_print_hex8(mon_probe_hw_low);
+    mon_puts(", total ");
+    mon_print_dec(0x100 - mon_probe_hw_low);
+    mon_puts("/256)");
+    mon_newline();
+    
+    mon_msg(MSG_PROBE_C);
+    mon_print_dec(mon_probe_csp - mon_probe_c_low);
+    mon_msg(MSG_PROBE_PEAK);
+    mon_print_hex16(mon_probe_c_low);
+    mon_puts(", total ");
+    mon_print_dec(STACK_END + 1 - mon_probe_c_low);
+    mon_puts("/");
+    mon_print_dec(STACK_END - STACK_START + 1);
+    mon_putc(')');
+    mon_newline();
+    
+    /* Rangos de zero page libre con bytes distintos del relleno */
+    mon_msg(MSG_PROBE_ZP);
+    for (zp = mon_probe_zp; zp <= 0x100; zp++) {
+        if (zp < 0x100 && mon_read_byte(zp) != MON_PROBE_FILL) {
+            if (!in_run) {
+                in_run = 1;
+                run_start = (uint8_t)zp;
+            }
+        } else if (in_run) {
+            in_run = 0;
+            any = 1;
+            mon_puts(" $");
+            mon_print_hex8(run_start);
+            if ((uint8_t)(zp - 1) != run_start) {
+                mon_puts("-$");
+                mon_print_hex8((uint8_t)(zp - 1));
+            }
+        }
+    }
+    if (!any) mon_puts(" ninguna");
+    mon_msg(MSG_PROBE_ZP_FREE);
+    mon_print_hex8(mon_probe_zp);
+    mon_putc(')');
+    mon_newline();
+}
+
+/* ============================================
+ * CARGA REUBICABLE
+ * ============================================ */
+
+/*
+ * Formato reubicable (ver scripts/mkreloc.py), little-endian:
+ *   'R','L', nombre[8], página de enlace, len código, bytes extra (BSS),
+ *   n reubicaciones, offset de entrada | código | offsets de bytes altos
+ * Las reubicaciones suman (página destino - página de enlace) a cada
+ * byte listado, por eso el destino debe empezar en frontera de página.
+ */
+#define RELOC_HDR_LEN    19
+#define RELOC_H_PAGE     10
+#define RELOC_H_LEN      11
+#define RELOC_H_EXTRA    13
+#define RELOC_H_COUNT    15
+#define RELOC_H_ENTRY    17
+
+#define hdr_word(h, o)   ((h)[o] | ((uint16_t)(h)[(o) + 1] << 8))
+
+/**
+ * Descartar el resto de una carga hasta el '.'
+ */
+static void mon_recv_drain(void) {
+    uint8_t b;
+    while (mon_recv_hex(&b)) {
+    }
+}
+
+/**
+ * Cargar un programa reubicable en 'dest' (0 = buscar RAM libre),
+ * aplicando las reubicaciones mientras llegan los datos
+ */
+static void mon_reloc_load(uint16_t dest) {
+    uint8_t hdr[RELOC_HDR_LEN];
+    uint8_t b, lo;
+    uint8_t delta;
+    uint16_t i, code_len, size, count, off, rel;
+    
+    mon_msg(MSG_RELOC_HEAD);
+    mon_putc(':');
+    
+    for (i = 0; i < RELOC_HDR_LEN; i++) {
+        if (!mon_recv_hex(&hdr[i])) {
+            mon_newline();
+            mon_error(MSG_E_HEADER);
+            stats.load_fail++;
+            return;
+        }
+    }
+    
+    if (hdr[0] != 'R' || hdr[1] != 'L') {
+        stats.load_fail++;
+        mon_newline();
+        mon_error(MSG_E_NOT_RELOC);
+        mon_recv_drain();
+        return;
+    }
+    
+    code_len = hdr_word(hdr, RELOC_H_LEN);
+    size = code_len + hdr_word(hdr, RELOC_H_EXTRA);
+    count = hdr_word(hdr, RELOC_H_COUNT);
+    
+    if (dest == 0) {
+        dest = mon_find_free(USER_START, USER_END, size);
+    }
+    if (dest == 0 || (dest & 0xFF) != 0 || size < code_len ||
+        dest < USER_START || dest > USER_END || size > USER_END - dest + 1) {
+        stats.load_fail++;
+        mon_newline();
+        mon_error(dest ? MSG_E_BAD_DEST : MSG_E_NO_RAM);
+        mon_recv_drain();
+        return;
+    }
+    
+    mon_newline();
+    mon_puts("-> $");
+    mon_print_hex16(dest);
+    mon_newline();
+    mon_putc(':');
+    
+    /* Código directamente a su destino */
+    for (i = 0; i < code_len; i++) {
+        if (!mon_recv_hex(&b)) break;
+        mon_write_byte(dest + i, b);
+    }
+    
+    /* Reubicar bytes altos según llegan */
+    delta = (uint8_t)(dest >> 8) - hdr[RELOC_H_PAGE];
+    for (off = 0; i == code_len && off < count; off++) {
+        if (!mon_recv_hex(&lo) || !mon_recv_hex(&b)) break;
+        rel = lo | ((uint16_t)b << 8);
+        if (rel >= code_len) {
+            /* El byte alto a parchear tiene que estar en el código */
+            stats.loaded += i + 2 * off;
+            stats.load_fail++;
+            mon_newline();
+            mon_error(MSG_E_BAD_RELOC);
+            mon_recv_drain();
+            return;
+        }
+        mon_write_byte(dest + rel, mon_read_byte(dest + rel) + delta);
+    }
+    
+    stats.loaded += i + 2 * off;
+    if (i != code_len || off != count) {
+        stats.load_fail++;
+        mon_newline();
+        mon_error(MSG_E_INCOMPLETE);
+        return;
+    }
+    mon_recv_drain();
+    
+    /* Zona extra (BSS) a cero */
+    mon_fill(dest + code_len, size - code_len, 0x00);
+    
+    if (mon_region_add((const char *)&hdr[2], dest, size,
+                       dest + hdr_word(hdr, RELOC_H_ENTRY)) != MON_OK) {
+        mon_error(MSG_E_REG_FULL_A);
+    } else {
+        mon_region_crc(dest, code_len);
+    }
+    
+    mon_newline();
+    mon_msg(MSG_RELOC_AT);
+    mon_print_hex16(dest);
+    mon_puts("-$");
+    mon_print_hex16(dest + size - 1);
+    mon_puts(", ");
+    mon_print_dec(count);
+    mon_msg(MSG_RELOC_COUNT);
+    
+    last_addr = dest;
+}
+
+/* ============================================
+ * PASO A PASO Y TRAZA
+ * ============================================ */
+
+/* Contexto del programa depurado (mon_step.s) */
+typedef struct {
+    uint16_t pc;
+    uint8_t  a, x, y, p, s;
+} mon_ctx_regs;
+
+extern mon_ctx_regs mon_ctx;
+extern uint32_t mon_ctx_t0, mon_ctx_t1;
+uint8_t mon_ctx_go(void);
+void mon_ctx_brk(void);
+void mon_ctx_exit(void);
+
+#define CTX_BRK          0
+#define CTX_EXIT         1
+
+/* Ciclos entre las lecturas del contador de mon_ctx_go y ctx_leave que
+ * no son del programa: entrada por RTI y salida por el RTS final (el
+ * RTS cuenta como del programa) o por BRK, mon_irq_entry y mon_ctx_brk */
+#define CTX_EXIT_CYCLES  89UL
+#define CTX_BRK_CYCLES   140UL
+
+/* S inicial del programa: $C0-$FF de la página 1 quedan al monitor */
+#define CTX_S0           0xBF
+
+/* Se puede parchear un BRK en addr: solo zonas libres del mapa (ni la
+ * zero page del runtime, ni la página 1, ni la RAM y pila del monitor) */
+#define step_ram(addr)   mon_is_free(addr)
+
+/* Resultado de un paso */
+#define STEP_OK          0
+#define STEP_END         1      /* RTS del nivel superior */
+#define STEP_BRK         2      /* BRK del propio programa */
+#define STEP_ROM         3      /* La siguiente instrucción no está en RAM libre */
+
+/* Entrada del buffer circular de traza (registros antes de ejecutar) */
+typedef struct {
+    uint16_t pc;
+    uint8_t  a, x, y, p;
+    uint8_t  cyc;               /* Ciclos estimados de la instrucción */
+} trace_entry;
+
+#define TRACE_MAX        32     /* Potencia de 2 */
+
+static trace_entry trace_buf[TRACE_MAX];
+static uint8_t trace_head;
+static uint8_t trace_count;
+static uint32_t step_cycles;
+static uint8_t step_active;
+
+/* Ciclos base por opcode, dos por byte (nibble bajo = opcode par) */
+static const uint8_t cycle_tab[128] = {
+    0x67, 0x22, 0x32, 0x25, 0x23, 0x22, 0x42, 0x26, 0x52, 0x22, 0x42, 0x26, 0x42, 0x22, 0x42, 0x27,
+    0x66, 0x22, 0x33, 0x25, 0x24, 0x22, 0x44, 0x26, 0x52, 0x22, 0x42, 0x26, 0x42, 0x22, 0x42, 0x27,
+    0x66, 0x22, 0x32, 0x25, 0x23, 0x22, 0x43, 0x26, 0x52, 0x22, 0x42, 0x26, 0x42, 0x22, 0x42, 0x27,
+    0x66, 0x22, 0x32, 0x25, 0x24, 0x22, 0x45, 0x26, 0x52, 0x22, 0x42, 0x26, 0x42, 0x22, 0x42, 0x27,
+    0x62, 0x22, 0x33, 0x23, 0x22, 0x22, 0x44, 0x24, 0x62, 0x22, 0x44, 0x24, 0x52, 0x22, 0x52, 0x22,
+    0x62, 0x22, 0x33, 0x23, 0x22, 0x22, 0x44, 0x24, 0x52, 0x22, 0x44, 0x24, 0x42, 0x22, 0x44, 0x24,
+    0x62, 0x22, 0x33, 0x25, 0x22, 0x22, 0x44, 0x26, 0x52, 0x22, 0x42, 0x26, 0x42, 0x22, 0x42, 0x27,
+    0x62, 0x22, 0x33, 0x25, 0x22, 0x22, 0x44, 0x26, 0x52, 0x22, 0x42, 0x26, 0x42, 0x22, 0x42, 0x27
+};
+
+/* Flag que evalúa cada rama según los bits 6-7 del opcode: N, V, C, Z */
+static const uint8_t branch_flag[4] = { 0x80, 0x40, 0x01, 0x02 };
+
+static const char flag_names[] = "NV-BDIZC";
+
+/* Byte de la pila del programa en S+o */
+#define ctx_stack(o)     mon_read_byte(0x0100 + (uint8_t)(mon_ctx.s + (o)))
+
+static uint16_t mon_read_word(uint16_t addr) {
+    return mon_read_byte(addr) | ((uint16_t)mon_read_byte(addr + 1) << 8);
+}
+
+/**
+ * Empezar una sesión en addr: registros a cero y pila propia con la
+ * dirección de retorno a mon_ctx_exit (un RTS final cierra la sesión)
+ */
+static void mon_step_start(uint16_t addr) {
+    uint16_t ret = (uint16_t)mon_ctx_exit - 1;
+    
+    mon_write_byte(0x0100 + CTX_S0, (uint8_t)(ret >> 8));
+    mon_write_byte(0x0100 + CTX_S0 - 1, (uint8_t)ret);
+    mon_ctx.pc = addr;
+    mon_ctx.a = 0;
+    mon_ctx.x = 0;
+    mon_ctx.y = 0;
+    mon_ctx.p = 0x24;           /* I=1, como tras reset */
+    mon_ctx.s = CTX_S0 - 2;
+    
+    step_cycles = 0;
+    trace_head = 0;
+    trace_count = 0;
+    step_active = 1;
+}
+
+/**
+ * Hay contador de ciclos: dos lecturas seguidas del byte bajo avanzan lo
+ * que tardan las instrucciones entre ellas (sin contador, el bus da un
+ * valor fijo o basura)
+ */
+static uint8_t mon_counter_ok(void) {
+    uint8_t t0, t1;
+    
+    t0 = MON_COUNTER_LO;
+    t1 = MON_COUNTER_LO;
+    t1 -= t0;
+    return t1 != 0 && t1 < COUNTER_STEP_MAX;
+}
+
+/**
+ * Reanudar el programa desde mon_ctx con BRK hacia mon_ctx_brk. Al
+ * volver (RTS final o BRK) restaura los vectores por defecto: con el
+ * monitor al mando un BRK (J, G) no debe caer en un contexto ya cerrado
+ */
+static uint8_t mon_ctx_run(void) {
+    uint8_t r;
+    
+    mon_vec_install(MON_VEC_BRK, mon_ctx_brk);
+    r = mon_ctx_go();
+    mon_vec_reset();
+    return r;
+}
+
+/**
+ * PC tras ejecutar la instrucción 'op' en 'pc' con los registros de
+ * mon_ctx ('over' no entra en JSR; fuera de la RAM libre nunca se entra)
+ */
+static uint16_t mon_step_next(uint16_t pc, uint8_t op, uint8_t over) {
+    uint16_t target;
+    
+    switch (op) {
+        case 0x4C: /* JMP abs */
+            return mon_read_word(pc + 1);
+        case 0x6C: /* JMP (ind): el byte alto no cruza de página */
+            target = mon_read_word(pc + 1);
+            return mon_read_byte(target) |
+                   ((uint16_t)mon_read_byte((target & 0xFF00) | ((target + 1) & 0xFF)) << 8);
+        case 0x20: /* JSR */
+            target = mon_read_word(pc + 1);
+            if (!over && step_ram(target)) return target;
+            break;
+        case 0x60: /* RTS */
+            return (ctx_stack(1) | ((uint16_t)ctx_stack(2) << 8)) + 1;
+        case 0x40: /* RTI */
+            return ctx_stack(2) | ((uint16_t)ctx_stack(3) << 8);
+    }
+    
+    /* Ramas: evaluar la condición con el P guardado */
+    if ((op & 0x1F) == 0x10 &&
+        ((mon_ctx.p & branch_flag[op >> 6]) != 0) == ((op & 0x20) != 0)) {
+        return pc + 2 + (int8_t)mon_read_byte(pc + 1);
+    }
+    
+    return pc + get_instruction_len(op);
+}
+
+/**
+ * Ciclos estimados: tabla base + rama tomada + cruce de página en
+ * lecturas indexadas
+ */
+static uint8_t mon_step_cycles(uint16_t pc, uint8_t op, uint16_t next) {
+    uint8_t cyc = cycle_tab[op >> 1];
+    uint8_t mode = (op >> 2) & 0x07;
+    uint8_t zp, idx;
+    uint16_t base;
+    
+    cyc = (op & 1) ? (cyc >> 4) : (cyc & 0x0F);
+    
+    if ((op & 0x1F) == 0x10) {
+        if (next != pc + 2) {
+            cyc += ((next ^ (pc + 2)) & 0xFF00) ? 2 : 1;
+        }
+        return cyc;
+    }
+    
+    if ((op & 0x03) == 0x01 && (op & 0xE0) != 0x80) {   /* ALU salvo STA */
+        if (mode == 4) {                                 /* (zp),Y */
+            zp = mon_read_byte(pc + 1);
+            base = mon_read_byte(zp) | ((uint16_t)mon_read_byte((uint8_t)(zp + 1)) << 8);
+            idx = mon_ctx.y;
+        } else if (mode == 6 || mode == 7) {             /* abs,Y / abs,X */
+            base = mon_read_word(pc + 1);
+            idx = (mode == 6) ? mon_ctx.y : mon_ctx.x;
+        } else {
+            return cyc;
+        }
+    } else if (op == 0xBC || op == 0xBE) {               /* LDY abs,X / LDX abs,Y */
+        base = mon_read_word(pc + 1);
+        idx = (op == 0xBC) ? mon_ctx.x : mon_ctx.y;
+    } else {
+        return cyc;
+    }
+    
+    if ((uint16_t)(uint8_t)base + idx > 0xFF) cyc++;
+    return cyc;
+}
+
+/**
+ * Ejecutar una instrucción del programa: BRK en la siguiente y
+ * mon_ctx_go. La instrucción queda en el buffer de traza
+ */
+static uint8_t mon_step_one(uint8_t over) {
+    uint16_t pc = mon_ctx.pc;
+    uint8_t op = mon_read_byte(pc);
+    uint16_t next;
+    uint8_t saved;
+    uint8_t r = CTX_BRK;
+    trace_entry *t;
+    
+    if (op == 0x00) return STEP_BRK;
+    
+    next = mon_step_next(pc, op, over);
+    if (next != (uint16_t)mon_ctx_exit && !step_ram(next)) return STEP_ROM;
+    
+    t = &trace_buf[trace_head];
+    t->pc = pc;
+    t->a = mon_ctx.a;
+    t->x = mon_ctx.x;
+    t->y = mon_ctx.y;
+    t->p = mon_ctx.p;
+    t->cyc = mon_step_cycles(pc, op, next);
+    trace_head = (trace_head + 1) & (TRACE_MAX - 1);
+    if (trace_count < TRACE_MAX) trace_count++;
+    step_cycles += t->cyc;
+    
+    /* Salto a sí mismo: el estado no cambia */
+    if (next == pc) return STEP_OK;
+    
+    if (next == (uint16_t)mon_ctx_exit) {
+        r = mon_ctx_run();
+    } else {
+        saved = mon_read_byte(next);
+        mon_write_byte(next, 0x00);
+        r = mon_ctx_run();
+        mon_write_byte(next, saved);
+    }
+    
+    if (r == CTX_EXIT) {
+        step_active = 0;
+        return STEP_END;
+    }
+    return (mon_ctx.pc == next) ? STEP_OK : STEP_BRK;
+}
+
+/**
+ * Mostrar registros y la siguiente instrucción
+ */
+static void mon_step_show(void) {
+    uint8_t i;
+    
+    mon_puts("PC=");
+    mon_print_hex16(mon_ctx.pc);
+    mon_puts(" A=");
+    mon_print_hex8(mon_ctx.a);
+    mon_puts(" X=");
+    mon_print_hex8(mon_ctx.x);
+    mon_puts(" Y=");
+    mon_print_hex8(mon_ctx.y);
+    mon_puts(" S=");
+    mon_print_hex8(mon_ctx.s);
+    mon_puts(" P=");
+    for (i = 0; i < 8; i++) {
+        mon_putc((mon_ctx.p & (0x80 >> i)) ? flag_names[i] : '.');
+    }
+    mon_newline();
+    mon_disassemble(mon_ctx.pc, 1);
+}
+
+/**
+ * Informar de por qué se detuvo la ejecución
+ */
+static void mon_step_report(uint8_t r) {
+    switch (r) {
+        case STEP_END:
+            mon_msg(MSG_STEP_END);
+            break;
+        case STEP_BRK:
+            mon_puts("BRK en $");
+            mon_print_hex16(mon_ctx.pc);
+            break;
+        case STEP_ROM:
+            mon_msg(MSG_STEP_ROM);
+            break;
+        default:
+            return;
+    }
+    mon_newline();
+}
+
+/**
+ * Mostrar el buffer de traza (más antigua primero) y los ciclos
+ */
+static void mon_trace_show(void) {
+    const trace_entry *t;
+    uint8_t i = (trace_head - trace_count) & (TRACE_MAX - 1);
+    uint8_t n;
+    
+    mon_msg(MSG_TRACE_HEAD);
+    for (n = trace_count; n > 0; n--) {
+        t = &trace_buf[i];
+        mon_print_hex16(t->pc);
+        mon_print_space();
+        mon_print_hex8(t->a);
+        mon_print_space();
+        mon_print_hex8(t->x);
+        mon_print_space();
+        mon_print_hex8(t->y);
+        mon_print_space();
+        mon_print_hex8(t->p);
+        mon_print_space();
+        mon_print_dec(t->cyc);
+        mon_newline();
+        i = (i + 1) & (TRACE_MAX - 1);
+    }
+    mon_msg(MSG_TRACE_CYCLES);
+    mon_print_hex32(step_cycles);
+    mon_newline();
+}
+
+/**
+ * X / Y: un paso (Y ejecuta los JSR completos)
+ */
+static void mon_step(uint8_t over) {
+    if (!step_active) {
+        mon_error(MSG_E_SESSION_X);
+        return;
+    }
+    mon_step_report(mon_step_one(over));
+    if (step_active) mon_step_show();
+}
+
+/**
+ * Z n: ejecutar n instrucciones guardando la traza
+ */
+static void mon_trace(uint16_t n) {
+    uint8_t r = STEP_OK;
+    
+    if (!step_active) {
+        mon_error(MSG_E_SESSION_Z);
+        return;
+    }
+    while (n > 0 && r == STEP_OK) {
+        r = mon_step_one(0);
+        n--;
+    }
+    mon_step_report(r);
+    mon_trace_show();
+    if (step_active) mon_step_show();
+}
+
+/* ============================================
+ * BREAKPOINTS
+ * ============================================ */
+
+#define BP_MAX           8
+#define BP_COUNT         0x01   /* Solo contar, no parar */
+
+#define STEP_BP          4      /* Parado en un breakpoint */
+
+/* Breakpoint (libre si addr == 0) */
+typedef struct {
+    uint16_t addr;
+    uint16_t hits;
+    uint16_t skip;      /* Impactos a ignorar antes de parar */
+    uint8_t  orig;      /* Byte original mientras está el BRK */
+    uint8_t  flags;
+} mon_bp;
+
+static mon_bp bp_table[BP_MAX];
+
+static mon_bp* mon_bp_find(uint16_t addr) {
+    uint8_t i;
+    for (i = 0; i < BP_MAX; i++) {
+        if (bp_table[i].addr == addr && addr != 0) return &bp_table[i];
+    }
+    return 0;
+}
+
+/**
+ * Poner (restore = 0) o quitar (restore = 1) los BRK de todos los
+ * breakpoints
+ */
+static void mon_bp_patch(uint8_t restore) {
+    mon_bp *bp;
+    uint8_t i;
+    
+    for (i = 0; i < BP_MAX; i++) {
+        bp = &bp_table[i];
+        if (bp->addr == 0) continue;
+        if (restore) {
+            mon_write_byte(bp->addr, bp->orig);
+        } else {
+            bp->orig = mon_read_byte(bp->addr);
+            mon_write_byte(bp->addr, 0x00);
+        }
+    }
+}
+
+/**
+ * Ejecutar desde mon_ctx a toda velocidad hasta un breakpoint que
+ * deba parar, un BRK ajeno o el RTS final. Los breakpoints que solo
+ * cuentan (o aún saltan impactos) se reanudan sin imprimir nada: se
+ * parchean una vez y al pasar por uno solo se restaura su instrucción
+ * durante un paso y se rearma ese
+ */
+static uint8_t mon_bp_run(void) {
+    mon_bp *bp;
+    uint8_t r;
+    
+    mon_bp_patch(0);
+    while (1) {
+        bp = mon_bp_find(mon_ctx.pc);
+        if (bp) {
+            mon_write_byte(bp->addr, bp->orig);
+            r = mon_step_one(0);
+            mon_write_byte(bp->addr, 0x00);
+        } else {
+            r = mon_ctx_run();
+            if (r == CTX_EXIT) {
+                step_active = 0;
+                r = STEP_END;
+            } else {
+                r = mon_bp_find(mon_ctx.pc) ? STEP_OK : STEP_BRK;
+            }
+        }
+        if (r != STEP_OK) break;
+        
+        bp = mon_bp_find(mon_ctx.pc);
+        if (bp) {
+            bp->hits++;
+            if (bp->hits > bp->skip && !(bp->flags & BP_COUNT)) {
+                r = STEP_BP;
+                break;
+            }
+        }
+    }
+    mon_bp_patch(1);
+    return r;
+}
+
+/**
+ * Poner o actualizar un breakpoint (reinicia su contador)
+ */
+static void mon_bp_set(uint16_t addr, uint16_t skip, uint8_t flags) {
+    mon_bp *bp = mon_bp_find(addr);
+    uint8_t i;
+    
+    if (!step_ram(addr)) {
+        mon_error(MSG_E_RAM_ONLY);
+        return;
+    }
+    for (i = 0; bp == 0 && i < BP_MAX; i++) {
+        if (bp_table[i].addr == 0) bp = &bp_table[i];
+    }
+    if (bp == 0) {
+        mon_error(MSG_E_BP_FULL);
+        return;
+    }
+    bp->addr = addr;
+    bp->hits = 0;
+    bp->skip = skip;
+    bp->flags = flags;
+    mon_ok();
+}
+
+/**
+ * Listar breakpoints con sus contadores
+ */
+static void mon_bp_list(void) {
+    const mon_bp *bp;
+    uint8_t i;
+    uint8_t any = 0;
+    
+    for (i = 0; i < BP_MAX; i++) {
+        bp = &bp_table[i];
+        if (bp->addr == 0) continue;
+        any = 1;
+        mon_puts("  $");
+        mon_print_hex16(bp->addr);
+        mon_msg(MSG_BP_HITS);
+        mon_print_dec(bp->hits);
+        mon_puts(" saltar ");
+        mon_print_dec(bp->skip);
+        if (bp->flags & BP_COUNT) mon_msg(MSG_BP_COUNT);
+        mon_newline();
+    }
+    if (!any) {
+        mon_msg(MSG_NO_BP);
+    }
+}
+
+/**
+ * Quitar un breakpoint (addr = 0: todos)
+ */
+static void mon_bp_clear(uint16_t addr) {
+    uint8_t i;
+    for (i = 0; i < BP_MAX; i++) {
+        if (addr == 0 || bp_table[i].addr == addr) bp_table[i].addr = 0;
+    }
+}
+
+/* ============================================
+ * EJECUCIÓN DE CÓDIGO
+ * ============================================ */
+
+/**
+ * Ejecutar desde mon_ctx con breakpoints e informar si se detuvo
+ * Retorna STEP_END si el programa terminó (sin imprimir nada)
+ */
+static uint8_t mon_continue(void) {
+    uint8_t r = mon_bp_run();
+    
+    if (r == STEP_END) return r;
+    
+    if (r == STEP_BP) {
+        mon_msg(MSG_BP_AT);
+        mon_print_hex16(mon_ctx.pc);
+        mon_newline();
+    } else {
+        mon_step_report(r);
+    }
+    mon_step_show();
+    return r;
+}
+
+/**
+ * Mensaje de retorno de G
+ */
+static void mon_returned(uint16_t addr) {
+    stats.returns++;
+    mon_newline();
+    mon_msg(MSG_RETURN_FROM);
+    mon_print_hex16(addr);
+    mon_newline();
+}
+
+void mon_execute(uint16_t addr) {
+    stats.runs++;
+    mon_msg(MSG_RUN_AT);
+    mon_print_hex16(addr);
+    mon_puts("...");
+    mon_newline();
+    
+    mon_step_start(addr);
+    
+    if (!exec_probe) {
+        if (mon_continue() == STEP_END) mon_returned(addr);
+        return;
+    }
+    
+    /* Con sondas: sin breakpoints ni código C entre pintar y recoger */
+    mon_vec_install(MON_VEC_BRK, mon_ctx_brk);
+    mon_probe_paint();
+    if (mon_ctx_go() == CTX_EXIT) {
+        mon_probe_collect();
+        mon_vec_reset();
+        step_active = 0;
+        mon_returned(addr);
+    } else {
+        mon_probe_collect();
+        mon_vec_reset();
+        mon_step_report(STEP_BRK);
+        mon_step_show();
+    }
+}
+
+/* ============================================
+ * MODO BATCH (@)
+ * ============================================ */
+
+/* Marcas de la salida del programa (ver scripts/batchrun.py) */
+#define BATCH_STX        0x02
+#define BATCH_ETX        0x03
+
+/* Estado del resultado */
+#define BATCH_END        0x00   /* RTS del nivel superior */
+#define BATCH_BRK        0x01   /* BRK del programa */
+#define BATCH_WATCHDOG   0x02   /* Presupuesto de ciclos agotado */
+#define BATCH_ROM        0x03   /* Salto fuera de RAM (con vigilancia) */
+
+#define BATCH_KCYCLES    1000UL
+
+/**
+ * @ addr [n [celda]] [S]: ejecutar para un host. La salida del programa
+ * va entre STX y ETX, seguida de "@ss cc tttttttt": estado, código de
+ * salida (A al volver, o el byte de 'celda') y ciclos.
+ * Por defecto corre a toda velocidad y los ciclos salen del contador
+ * libre (0 sin contador); con n > 0, si pasa de n x 1000 ciclos el estado
+ * es vigilante aunque haya vuelto (no se puede cortar sin interrupción).
+ * Con S corre paso a paso (las llamadas a ROM a toda velocidad, ciclos
+ * estimados) y el vigilante lo detiene al pasar del presupuesto.
+ * Tras BRK o vigilante paso a paso la sesión sigue abierta para X, Z y C
+ */
+static void mon_batch(uint16_t addr, uint16_t kcycles, uint16_t cell, uint8_t step) {
+    uint32_t limit = kcycles * BATCH_KCYCLES;
+    uint32_t fixed;
+    uint8_t counter = mon_counter_ok();
+    uint8_t r;
+    uint8_t st;
+    
+    stats.runs++;
+    mon_step_start(addr);
+    mon_putc(BATCH_STX);
+    
+    if (!step) {
+        if (mon_ctx_run() == CTX_EXIT) {
+            step_active = 0;
+            r = STEP_END;
+            fixed = CTX_EXIT_CYCLES;
+        } else {
+            r = STEP_BRK;
+            fixed = CTX_BRK_CYCLES;
+        }
+        step_cycles = mon_ctx_t1 - mon_ctx_t0;
+        step_cycles = (counter && step_cycles > fixed) ? step_cycles - fixed : 0;
+        if (r == STEP_END && kcycles && step_cycles > limit) {
+            stats.returns++;
+            r = STEP_OK;        /* Volvió, pero fuera de presupuesto */
+        }
+    } else {
+        do {
+            r = mon_step_one(0);
+        } while (r == STEP_OK && (kcycles == 0 || step_cycles < limit));
+    }
+    
+    mon_putc(BATCH_ETX);
+    
+    switch (r) {
+        case STEP_END: st = BATCH_END; stats.returns++; break;
+        case STEP_BRK: st = BATCH_BRK; break;
+        case STEP_ROM: st = BATCH_ROM; break;
+        default:       st = BATCH_WATCHDOG; break;
+    }
+    mon_putc('@');
+    mon_print_hex8(st);
+    mon_print_space();
+    mon_print_hex8(cell ? mon_read_byte(cell) : mon_ctx.a);
+    mon_print_space();
+    mon_print_hex32(step_cycles);
+    mon_newline();
+}
+
+/* ============================================
+ * BENCHMARK (J)
+ * ============================================ */
+
+/* Llamadas a mon_bench_nop para medir el coste fijo */
+#define BENCH_CAL        4
+
+/**
+ * Imprimir un valor de 32 bits en decimal
+ */
+static void mon_print_dec32(uint32_t val) {
+    char buf[10];
+    uint8_t i = 0;
+    
+    do {
+        buf[i++] = '0' + (uint8_t)(val % 10);
+        val /= 10;
+    } while (val > 0);
+    
+    while (i > 0) {
+        mon_putc(buf[--i]);
+    }
+}
+
+/**
+ * J addr [n [a [x [y]]]]: llamar n veces a addr (como con JSR, A/X/Y
+ * dados) y medir cada llamada con el contador libre. Al resultado se le
+ * resta el coste fijo medido con mon_bench_nop (lectura del contador,
+ * entrada y su RTS): quedan los ciclos del cuerpo de la rutina, sin
+ * JSR/RTS. ESC o Ctrl-C corta y muestra lo medido hasta ahí
+ */
+static void mon_bench(uint16_t addr, uint16_t n, uint8_t a, uint8_t x, uint8_t y) {
+    uint32_t overhead = 0xFFFFFFFFUL;
+    uint32_t lo = 0xFFFFFFFFUL;
+    uint32_t hi = 0;
+    uint32_t sum = 0;
+    uint32_t t;
+    uint16_t done;
+    
+    if (!mon_counter_ok()) {
+        mon_error(MSG_E_NO_COUNTER);
+        return;
+    }
+    
+    mon_bench_addr = (uint16_t)mon_bench_nop;
+    for (done = 0; done < BENCH_CAL; done++) {
+        mon_bench_call();
+        if (mon_bench_ticks < overhead) overhead = mon_bench_ticks;
+    }
+    
+    mon_bench_addr = addr;
+    mon_bench_regs[0] = a;
+    mon_bench_regs[1] = x;
+    mon_bench_regs[2] = y;
+    for (done = 0; done < n; ) {
+        mon_bench_call();
+        /* Una IRQ en la calibración o un contador que da la vuelta pueden
+         * dejar la muestra por debajo del coste fijo */
+        t = (mon_bench_ticks > overhead) ? mon_bench_ticks - overhead : 0;
+        if (t < lo) lo = t;
+        if (t > hi) hi = t;
+        sum += t;
+        done++;
+        if (mon_abort(addr)) break;
+    }
+    
+    mon_print_dec(done);
+    mon_msg(MSG_BENCH_CALLS);
+    mon_print_dec32(lo);
+    mon_puts(", media ");
+    mon_print_dec32(sum / done);
+    mon_puts(", max ");
+    mon_print_dec32(hi);
+    mon_msg(MSG_BENCH_FIXED);
+    mon_print_dec32(overhead);
+    mon_putc(')');
+    mon_newline();
+}
+
+/* ============================================
+ * OBSERVAR MEMORIA (WATCH)
+ * ============================================ */
+
+#define WATCH_MAX  256
+
+/* Copia del rango observado */
+static uint8_t watch_shadow[WATCH_MAX];
+
+/**
+ * Esperar 'ticks' x 100 ms o hasta que llegue una tecla
+ * Retorna 1 si se pulsó una tecla
+ */
+static uint8_t mon_wait_key(uint8_t ticks) {
+    uint16_t n;
+    uint8_t t;
+    
+    while (ticks > 0) {
+        for (t = 0; t < 10; t++) {
+            for (n = 0; n < MON_TICK_LOOPS; n++) {
+                if (mon_rx_ready()) return 1;
+            }
+        }
+        ticks--;
+    }
+    return 0;
+}
+
+/**
+ * Actualizar un byte en la rejilla ya impresa con secuencias ANSI
+ * (guardar cursor, subir a su fila, escribir hex y ASCII, restaurar)
+ */
+static void mon_watch_ansi(uint8_t offset, uint8_t rows, uint8_t val) {
+    mon_puts("\x1B" "7\x1B[");
+    mon_print_dec(rows - (offset >> 4));
+    mon_puts("A\x1B[");
+    mon_print_dec(7 + (offset & 0x0F) * 3);
+    mon_putc('G');
+    mon_print_hex8(val);
+    mon_puts("\x1B[");
+    mon_print_dec(56 + (offset & 0x0F));
+    mon_putc('G');
+    mon_putc((val >= 0x20 && val < 0x7F) ? val : '.');
+    mon_puts("\x1B" "8");
 }
 
 /**
- * Prueba de RAM: escribir y leer para verificar que funciona
- * Usa un test simple: escribe valor, lee, verifica
+ * Observar un rango: re-muestrear y emitir solo los bytes que cambian
+ * ticks = 0: muestrear con cada tecla (ESC o '.' termina)
+ * ticks > 0: muestrear cada ticks x 100 ms (cualquier tecla termina)
  */
-static void mon_test_ram(uint16_t start, uint16_t len) {
+static void mon_watch(uint16_t addr, uint16_t len, uint8_t ticks, uint8_t ansi) {
     uint16_t i;
-    uint16_t addr;
-    uint8_t original;
-    uint8_t test_val;
-    uint8_t read_val;
-    uint16_t errors = 0;
-    uint16_t ok = 0;
-    
-    uart_puts("Test RAM $");
-    mon_print_hex16(start);
-    uart_puts("-$");
-    mon_print_hex16(start + len - 1);
-    mon_newline();
+    uint8_t val;
+    uint8_t changes;
+    uint8_t rows;
+    char c;
     
     for (i = 0; i < len; i++) {
-        addr = start + i;
-        
-        /* Guardar valor original */
-        original = mon_read_byte(addr);
-        
-        /* Test 1: escribir $55 */
-        test_val = 0x55;
-        mon_write_byte(addr, test_val);
-        read_val = mon_read_byte(addr);
-        
-        if (read_val != test_val) {
-            errors++;
-            if (errors <= 5) {
-                uart_puts("  $");
-                mon_print_hex16(addr);
-                uart_puts(" W:");
-                mon_print_hex8(test_val);
-                uart_puts(" R:");
-                mon_print_hex8(read_val);
-                mon_newline();
+        watch_shadow[i] = mon_read_byte(addr + i);
+    }
+    
+    mon_msg(MSG_WATCH_AT);
+    mon_print_hex16(addr);
+    mon_puts("-$");
+    mon_print_hex16(addr + len - 1);
+    mon_msg(ticks ? MSG_WATCH_KEY : MSG_WATCH_SAMPLE);
+    
+    rows = (uint8_t)((len + 15) >> 4);
+    for (i = 0; i < len; i += 16) {
+        mon_dump_row(addr + i, (len - i) < 16 ? (uint8_t)(len - i) : 16);
+    }
+    
+    while (1) {
+        if (ticks) {
+            if (mon_wait_key(ticks)) {
+                mon_getc();
+                break;
             }
         } else {
-            /* Test 2: escribir $AA (complemento) */
-            test_val = 0xAA;
-            mon_write_byte(addr, test_val);
-            read_val = mon_read_byte(addr);
+            c = mon_getc();
+            if (c == 0x1B || c == '.') break;
+        }
+        
+        changes = 0;
+        for (i = 0; i < len; i++) {
+            val = mon_read_byte(addr + i);
+            if (val == watch_shadow[i]) continue;
+            watch_shadow[i] = val;
             
-            if (read_val != test_val) {
-                errors++;
-                if (errors <= 5) {
-                    uart_puts("  $");
-                    mon_print_hex16(addr);
-                    uart_puts(" W:");
-                    mon_print_hex8(test_val);
-                    uart_puts(" R:");
-                    mon_print_hex8(read_val);
-                    mon_newline();
-                }
+            if (ansi) {
+                mon_watch_ansi((uint8_t)i, rows, val);
             } else {
-                ok++;
+                mon_print_hex16(addr + i);
+                mon_putc('=');
+                mon_print_hex8(val);
+                mon_print_space();
+                changes++;
             }
         }
-        
-        /* Restaurar valor original */
-        mon_write_byte(addr, original);
+        if (changes) mon_newline();
     }
     
-    mon_newline();
-    if (errors == 0) {
-        uart_puts("OK: ");
-        mon_print_dec(ok);
-        uart_puts(" bytes");
-    } else {
-        uart_puts("FAIL: ");
-        mon_print_dec(errors);
-        uart_puts("/");
-        mon_print_dec(len);
-    }
-    mon_newline();
+    last_addr = addr + len;
 }
 
+/* ============================================
+ * PRUEBA DE LA UART
+ * ============================================ */
+
+/* Patrón imprimible '!'..'~' (sin CR ni XON/XOFF), ver scripts/uartbench.py */
+#define PAT_FIRST        '!'
+#define PAT_LEN          94
+#define PAT_MAX_GAP      8      /* Salto corto hacia delante = bytes perdidos */
+#define SINK_TICKS       200    /* ~2 s sin datos terminan la recepción */
+
+/* Bit de desborde de RX, solo si la UART lo tiene (ver libs/uart) */
+#ifdef MON_UART_RX_OVERRUN
+#define mon_rx_overrun()   (MON_UART_STATUS & MON_UART_RX_OVERRUN)
+#endif
+
 /**
- * Vista rápida de uso de memoria (mapa visual)
+ * Enviar n bytes del patrón tras la cabecera "TX nnnn"
  */
-static void mon_memmap(void) {
-    uint16_t page;
-    uint16_t addr;
-    uint8_t used_count;
-    uint8_t i;
-    char symbol;
+static void mon_uart_source(uint16_t n) {
+    uint8_t pos = 0;
     
-    uart_puts("Mapa de RAM (. = libre, # = usada, X = mixta)");
-    mon_newline();
-    uart_puts("Cada caracter = 256 bytes (1 pagina)");
+    mon_puts("TX ");
+    mon_print_hex16(n);
     mon_newline();
+    
+    while (n > 0) {
+        mon_putc(PAT_FIRST + pos);
+        if (++pos == PAT_LEN) pos = 0;
+        n--;
+    }
     mon_newline();
+}
+
+/**
+ * Recibir n bytes del patrón tras la cabecera "RX nnnn" y verificarlos.
+ * Un salto corto hacia delante cuenta como bytes perdidos (desborde) y
+ * resincroniza; cualquier otro byte inesperado cuenta como error.
+ * Termina al completar n o tras SINK_TICKS sin datos
+ */
+static void mon_uart_sink(uint16_t n) {
+    uint16_t got = 0;
+    uint16_t bad = 0;
+    uint16_t lost = 0;
+    uint16_t loops;
+    uint8_t ticks = 0;
+    uint8_t expect = 0;
+    uint8_t pos, gap;
+#ifdef MON_UART_RX_OVERRUN
+    uint16_t over = 0;
+#endif
     
-    uart_puts("     0123456789ABCDEF");
+    mon_puts("RX ");
+    mon_print_hex16(n);
     mon_newline();
     
-    /* Páginas de RAM: $01-$3D */
-    for (page = 0x01; page <= 0x3D; page++) {
-        if ((page & 0x0F) == 0x01) {
-            uart_puts("$");
-            mon_print_hex8((uint8_t)page);
-            uart_puts(": ");
-        }
-        
-        /* Contar bytes usados en la página */
-        used_count = 0;
-        for (i = 0; i < 64; i++) { /* Muestrear cada 4 bytes */
-            addr = (page << 8) | (i << 2);
-            if (mon_read_byte(addr) != 0x00 && mon_read_byte(addr) != 0xFF) {
-                used_count++;
+    while (n > 0) {
+        loops = 0;
+        ticks = 0;
+        while (!mon_rx_ready()) {
+            if (++loops == MON_TICK_LOOPS) {
+                loops = 0;
+                if (++ticks == SINK_TICKS) break;
             }
         }
+        if (ticks == SINK_TICKS) break;
         
-        /* Determinar símbolo */
-        if (used_count == 0) {
-            symbol = '.';
-        } else if (used_count >= 60) {
-            symbol = '#';
-        } else {
-            symbol = 'X';
-        }
-        
-        uart_putc(symbol);
+#ifdef MON_UART_RX_OVERRUN
+        if (mon_rx_overrun()) over++;
+#endif
+        pos = (uint8_t)mon_getc() - PAT_FIRST;
+        got++;
+        n--;
         
-        if ((page & 0x0F) == 0x00 || page == 0x3D) {
-            mon_newline();
+        if (pos >= PAT_LEN) {
+            bad++;              /* Fuera del patrón: seguir la secuencia */
+            pos = expect;
+        } else if (pos != expect) {
+            gap = (pos > expect) ? pos - expect : pos + PAT_LEN - expect;
+            if (gap <= PAT_MAX_GAP) {
+                lost += gap;
+                n -= (gap < n) ? gap : n;
+            } else {
+                bad++;
+            }
         }
+        expect = (pos + 1 == PAT_LEN) ? 0 : pos + 1;
     }
     
+    mon_puts("RX: ");
+    mon_print_dec(got);
+    mon_msg(MSG_SINK_GOT);
+    mon_print_dec(bad);
+    mon_msg(MSG_SINK_BAD);
+    mon_print_dec(lost);
+    mon_msg(MSG_SINK_LOST);
+#ifdef MON_UART_RX_OVERRUN
+    mon_puts(", ");
+    mon_print_dec(over);
+    mon_msg(MSG_SINK_OVER);
+#endif
+    if (ticks == SINK_TICKS) mon_msg(MSG_SINK_TIMEOUT);
     mon_newline();
-    uart_puts("ZP=$02-$FF  Stack=$3E-$3F");
-    mon_newline();
+    
+    stats.rx_lost += lost;
+    stats.rx_errors += bad;
+#ifdef MON_UART_RX_OVERRUN
+    stats.rx_lost += over;
+#endif
 }
 
 /* ============================================
- * AYUDA
+ * ESTADÍSTICAS
  * ============================================ */
 
-static void mon_help(void) {
-    mon_newline();
-    uart_puts("=== MONITOR 6502 ===");
-    mon_newline();
-    uart_puts("Todo en HEX (addr=4dig)");
-    mon_newline();
-    uart_puts("--- BASICOS ---");
-    mon_newline();
-    uart_puts("R addr      | Leer byte");
-    mon_newline();
-    uart_puts("W addr val  | Escribir byte");
-    mon_newline();
-    uart_puts("D addr len  | Dump memoria");
-    mon_newline();
-    uart_puts("L addr      | Cargar hex (fin=.)");
-    mon_newline();
-    uart_puts("G addr      | Ejecutar codigo");
-    mon_newline();
-    uart_puts("F addr ln v | Fill memoria");
-    mon_newline();
-    uart_puts("M addr [n]  | Desensamblar");
-    mon_newline();
-    uart_puts("--- MEMORIA ---");
-    mon_newline();
-    uart_puts("I           | Info mapa mem");
-    mon_newline();
-    uart_puts("S addr len  | Scan mem libre");
-    mon_newline();
-    uart_puts("T addr len  | Test RAM");
-    mon_newline();
-    uart_puts("V           | Vista RAM");
-    mon_newline();
-    uart_puts("--- OTROS ---");
+static void mon_stats_reset(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * Porcentaje de 'part' sobre 'total' (total > 0, part <= total)
+ */
+static uint8_t mon_percent(uint32_t part, uint32_t total) {
+    while (total > 0x00FFFFFFUL) {
+        part >>= 8;
+        total >>= 8;
+    }
+    return (uint8_t)((part * 100) / total);
+}
+
+/**
+ * Imprimir "~t% TX, ~r% RX, ~c% CPU (estimado)". Sin reloj, el tiempo de
+ * línea de los bytes enviados (sondeos con TX libre x char_loops) más la
+ * espera de RX hace de total; lo que no se pasó esperando a la UART es
+ * trabajo de la CPU
+ */
+static void mon_wait_print(const mon_wait_t *w) {
+    uint32_t line = w->tx_ready * char_loops;
+    uint32_t tx = w->tx_busy < line ? w->tx_busy : line;
+    uint32_t total = line + w->rx_busy;
+    uint8_t tx_pct = 0;
+    uint8_t rx_pct = 0;
+
+    if (total != 0) {
+        tx_pct = mon_percent(tx, total);
+        rx_pct = mon_percent(w->rx_busy, total);
+    }
+    mon_putc('~');
+    mon_print_dec(tx_pct);
+    mon_puts("% TX, ~");
+    mon_print_dec(rx_pct);
+    mon_puts("% RX, ~");
+    mon_print_dec(100 - tx_pct - rx_pct);
+    mon_msg(MSG_USE_CPU);
+}
+
+/**
+ * Imprimir "etiqueta $total ($ocupados ocupado)" de los sondeos medidos
+ */
+static void mon_polls_line(uint8_t label, uint32_t ready, uint32_t busy) {
+    mon_msg(label);
+    mon_putc('$');
+    mon_print_hex32(ready + busy);
+    mon_puts(" ($");
+    mon_print_hex32(busy);
+    mon_msg(MSG_POLLS_BUSY);
+}
+
+/**
+ * Imprimir "  etiqueta n" con n de 16 bits en decimal
+ */
+static void mon_stats_line(uint8_t label, uint16_t val) {
+    mon_msg(label);
+    mon_print_dec(val);
     mon_newline();
-    uart_puts("H/?         | Ayuda");
+}
+
+/**
+ * Mostrar los contadores: comandos por letra (solo los usados) y totales
+ */
+static void mon_stats_show(void) {
+    uint8_t i;
+    uint8_t n = 0;
+    
+    mon_msg(MSG_ST_CMDS);
+    for (i = 0; i < STAT_LETTERS; i++) {
+        if (stats.cmds[i] == 0) continue;
+        if ((n++ & 7) == 0) {
+            mon_newline();
+            mon_putc(' ');
+        }
+        mon_print_space();
+        mon_putc('A' + i);
+        mon_putc('=');
+        mon_print_dec(stats.cmds[i]);
+    }
     mon_newline();
-    uart_puts("Q           | Salir");
+    mon_stats_line(MSG_ST_OTHER, stats.cmds_other);
+    mon_msg(MSG_ST_LOADED);
+    mon_print_hex32(stats.loaded);
     mon_newline();
-    uart_puts("Ej: D 8000 40  F 0200 100 EA");
+    mon_msg(MSG_ST_DUMPED);
+    mon_print_hex32(stats.dumped);
     mon_newline();
-    uart_puts("RAM libre: $0200-$3DFF");
+    mon_stats_line(MSG_ST_RUNS, stats.runs);
+    mon_stats_line(MSG_ST_RETURNS, stats.returns);
+    mon_stats_line(MSG_ST_RX_LOST, stats.rx_lost);
+    mon_stats_line(MSG_ST_RX_ERR, stats.rx_errors);
+    mon_stats_line(MSG_ST_LOAD_FAIL, stats.load_fail);
+    mon_polls_line(MSG_ST_POLLS_TX, stats.wait.tx_ready, stats.wait.tx_busy);
+    mon_polls_line(MSG_ST_POLLS_RX, stats.wait.rx_ready, stats.wait.rx_busy);
+    mon_msg(MSG_ST_USE);
+    mon_wait_print(&stats.wait);
+    mon_stats_line(MSG_ST_LOOPS, char_loops);
+}
+
+/**
+ * Fin de un comando: sumar sus esperas a la sesión y, con # U, mostrar
+ * "letra: uso"
+ */
+static void mon_wait_end(void) {
+    const char *p = input_buffer;
+    mon_wait_t w;
+
+    mon_wait_fold();
+    stats.wait.tx_ready += wait_cmd.tx_ready;
+    stats.wait.tx_busy += wait_cmd.tx_busy;
+    stats.wait.rx_ready += wait_cmd.rx_ready;
+    stats.wait.rx_busy += wait_cmd.rx_busy;
+
+    while (*p == ' ') p++;
+    if (!wait_show || *p == '\0') return;
+    memcpy(&w, &wait_cmd, sizeof(w));   /* Lo que se imprime ahora no cuenta */
+    mon_putc(*p >= 'a' && *p <= 'z' ? *p - 32 : *p);
+    mon_puts(": ");
+    mon_wait_print(&w);
+}
+
+/* ============================================
+ * AYUDA
+ * ============================================ */
+
+static void mon_help(void) {
+    mon_msg(MSG_HELP);
+    mon_msg(MSG_HELP_RAM);
+    mon_print_hex16(USER_START);
+    mon_puts("-$");
+    mon_print_hex16(USER_END);
     mon_newline();
 }
 
@@ -778,7 +2902,9 @@ static void mon_help(void) {
 uint8_t monitor_process_cmd(char *cmd) {
     char command;
     const char *ptr;
-    uint16_t addr, len, val;
+    uint16_t addr, len, val, end;
+    uint16_t reg_x, reg_y;
+    char name[BUNDLE_NAME_LEN + 1];
     
     /* Saltar espacios iniciales */
     while (*cmd == ' ') cmd++;
@@ -794,15 +2920,21 @@ uint8_t monitor_process_cmd(char *cmd) {
     
     ptr = cmd + 1;
     
+    if (command >= 'A' && command <= 'Z') {
+        stats.cmds[command - 'A']++;
+    } else {
+        stats.cmds_other++;
+    }
+    
     switch (command) {
         case 'R': /* Read byte */
             ptr = parse_hex_token(ptr, &addr);
             if (addr == 0 && ptr == cmd + 1) {
                 addr = last_addr;
             }
-            uart_putc('$');
+            mon_putc('$');
             mon_print_hex16(addr);
-            uart_puts(" = $");
+            mon_puts(" = $");
             mon_print_hex8(mon_read_byte(addr));
             mon_newline();
             last_addr = addr + 1;
@@ -812,9 +2944,9 @@ uint8_t monitor_process_cmd(char *cmd) {
             ptr = parse_hex_token(ptr, &addr);
             ptr = parse_hex_token(ptr, &val);
             mon_write_byte(addr, (uint8_t)val);
-            uart_putc('$');
+            mon_putc('$');
             mon_print_hex16(addr);
-            uart_puts(" <- $");
+            mon_puts(" <- $");
             mon_print_hex8((uint8_t)val);
             mon_newline();
             last_addr = addr + 1;
@@ -822,9 +2954,16 @@ uint8_t monitor_process_cmd(char *cmd) {
             
         case 'D': /* Dump */
             ptr = parse_hex_token(ptr, &addr);
+            if (parse_option(cmd + 1) == '\0') {
+                addr = last_addr;  /* Sin parámetros: continuar */
+            }
             ptr = parse_hex_token(ptr, &len);
             if (len == 0) len = 64; /* Default 64 bytes */
-            mon_dump(addr, len);
+            switch (parse_option(ptr)) {
+                case 'Z': mon_dump_ex(addr, len, MON_DUMP_SPARSE); break;
+                case 'T': mon_dump_ex(addr, len, MON_DUMP_ALL); break;
+                default:  mon_dump(addr, len); break;
+            }
             break;
             
         case 'L': /* Load mode */
@@ -835,7 +2974,12 @@ uint8_t monitor_process_cmd(char *cmd) {
             
         case 'G': /* Go/Execute */
             ptr = parse_hex_token(ptr, &addr);
+            exec_probe = (parse_option(ptr) == 'P');
             mon_execute(addr);
+            if (exec_probe) {
+                exec_probe = 0;
+                mon_probe_report();
+            }
             break;
             
         case 'F': /* Fill */
@@ -843,11 +2987,16 @@ uint8_t monitor_process_cmd(char *cmd) {
             ptr = parse_hex_token(ptr, &len);
             ptr = parse_hex_token(ptr, &val);
             mon_fill(addr, len, (uint8_t)val);
-            uart_puts("Filled $");
+            /* Borrar ($00/$FF) libera; otro valor registra el rango */
+            if (len != 0) {
+                mon_region_mark((val == 0x00 || val == 0xFF) ? 0 : "FILL", addr,
+                                (len - 1 > 0xFFFF - addr) ? 0xFFFF : addr + len - 1);
+            }
+            mon_puts("Filled $");
             mon_print_hex16(addr);
-            uart_puts("-$");
+            mon_puts("-$");
             mon_print_hex16(addr + len - 1);
-            uart_puts(" con $");
+            mon_puts(" con $");
             mon_print_hex8((uint8_t)val);
             mon_newline();
             break;
@@ -860,34 +3009,189 @@ uint8_t monitor_process_cmd(char *cmd) {
             mon_disassemble(addr, (uint8_t)len);
             break;
             
-        case 'I': /* Info - Mapa de memoria */
-            mon_info();
+        case 'P': /* Programas en ROM */
+            if (parse_name(ptr, name, BUNDLE_NAME_LEN) == 0) {
+                mon_bundle_list();
+            } else {
+                mon_bundle_run(name);
+            }
             break;
             
-        case 'S': /* Scan - Buscar memoria libre */
+        case 'O': /* Observar cambios en un rango */
+            ptr = parse_hex_token(ptr, &addr);
+            ptr = parse_hex_token(ptr, &len);
+            ptr = parse_hex_token(ptr, &val);
+            if (len == 0) len = 16;
+            if (len > WATCH_MAX) {
+                mon_error(MSG_E_WATCH_MAX);
+                break;
+            }
+            mon_watch(addr, len, (uint8_t)val, parse_option(ptr) == 'T');
+            break;
+            
+        case 'U': /* Carga reubicable */
+            ptr = parse_hex_token(ptr, &addr);
+            mon_reloc_load(addr);
+            break;
+            
+        case 'N': /* Programas residentes */
+            if (parse_name(ptr, name, MON_NAME_LEN) == 0) {
+                mon_region_list(1);
+            } else if (mon_region_find(name)) {
+                mon_execute(mon_region_find(name)->entry);
+            } else {
+                mon_error(MSG_E_NOT_FOUND);
+            }
+            break;
+            
+        case 'A': /* Registro de regiones */
+            if (parse_option(ptr) == '\0') {
+                mon_region_list(0);
+                break;
+            }
+            ptr = parse_hex_token(ptr, &addr);
+            ptr = parse_hex_token(ptr, &len);
+            if (len == 0) {
+                if (mon_region_free(addr) == MON_OK) {
+                    mon_ok();
+                } else {
+                    mon_error(MSG_E_NO_REGION);
+                }
+                break;
+            }
+            if (parse_name(ptr, name, MON_NAME_LEN) == 0) {
+                strcpy(name, "USUARIO");
+            }
+            if (mon_region_add(name, addr, len, 0) == MON_OK) {
+                mon_ok();
+            } else {
+                mon_error(MSG_E_REG_FULL);
+            }
+            break;
+            
+        case 'X': /* Paso a paso */
+        case 'Y': /* Paso sin entrar en subrutinas */
             ptr = parse_hex_token(ptr, &addr);
+            if (addr) mon_step_start(addr);
+            mon_step(command == 'Y');
+            break;
+            
+        case 'Z': /* Traza de n instrucciones */
             ptr = parse_hex_token(ptr, &len);
-            if (addr == 0) addr = 0x0200;  /* Default: inicio RAM usuario */
-            if (len == 0) len = 0x3BFF;    /* Default: toda la RAM */
-            if (addr + len > 0x3DFF) len = 0x3DFF - addr + 1;
-            mon_scan(addr, addr + len - 1);
+            ptr = parse_hex_token(ptr, &addr);
+            if (addr) mon_step_start(addr);
+            if (len == 0) {
+                mon_trace_show();
+            } else {
+                mon_trace(len);
+            }
+            break;
+            
+        case 'B': /* Breakpoints */
+            ptr = parse_hex_token(ptr, &addr);
+            if (addr == 0) {
+                mon_bp_list();
+                break;
+            }
+            ptr = parse_hex_token(ptr, &val);
+            mon_bp_set(addr, val, (parse_option(ptr) == 'N') ? BP_COUNT : 0);
+            break;
+            
+        case 'K': /* Quitar breakpoint(s) */
+            ptr = parse_hex_token(ptr, &addr);
+            mon_bp_clear(addr);
+            mon_ok();
+            break;
+            
+        case 'C': /* Continuar con breakpoints */
+            ptr = parse_hex_token(ptr, &addr);
+            if (addr) {
+                mon_step_start(addr);
+            } else if (!step_active) {
+                mon_error(MSG_E_SESSION_C);
+                break;
+            }
+            if (mon_continue() == STEP_END) mon_step_report(STEP_END);
+            break;
+            
+        case 'I': /* Info - Mapa de memoria */
+            mon_info();
             break;
             
+        case 'S': /* Scan - Buscar memoria libre */
         case 'T': /* Test RAM */
             ptr = parse_hex_token(ptr, &addr);
             ptr = parse_hex_token(ptr, &len);
-            if (addr == 0) addr = 0x0200;
-            if (len == 0) len = 0x100;  /* Default: 256 bytes */
-            mon_test_ram(addr, len);
+            if (len != 0) {
+                /* Rango explícito: S solo lee (vale ROM); T escribe y se
+                 * recorta a las zonas libres del mapa */
+                end = (len - 1 > 0xFFFF - addr) ? 0xFFFF : addr + len - 1;
+                if (command == 'S') {
+                    mon_scan(addr, end);
+                } else {
+                    mon_free_each(addr, end, mon_test_ram);
+                }
+                break;
+            }
+            /* Por defecto, en las zonas libres: S hasta el final de la RAM
+             * de usuario, T 256 bytes */
+            if (addr == 0) addr = USER_START;
+            if (command == 'S' && addr <= USER_END) {
+                end = USER_END;
+            } else {
+                end = (addr > 0xFF00) ? 0xFFFF : addr + 0xFF;
+            }
+            mon_free_each(addr, end, command == 'S' ? mon_scan : mon_test_ram);
             break;
             
         case 'V': /* Vista mapa de memoria */
             mon_memmap();
             break;
             
+        case 'E': /* Prueba de velocidad de la UART */
+            ptr = parse_hex_token(ptr, &len);
+            if (len == 0) len = 0x1000;
+            if (parse_option(ptr) == 'R') {
+                mon_uart_sink(len);
+            } else {
+                mon_uart_source(len);
+            }
+            break;
+            
+        case '@': /* Ejecución batch para el host */
+            ptr = parse_hex_token(ptr, &addr);
+            ptr = parse_hex_token(ptr, &len);
+            ptr = parse_hex_token(ptr, &val);
+            mon_batch(addr, len, val, parse_option(ptr) == 'S');
+            break;
+            
+        case 'J': /* Benchmark de una rutina */
+            ptr = parse_hex_token(ptr, &addr);
+            ptr = parse_hex_token(ptr, &len);
+            ptr = parse_hex_token(ptr, &val);
+            ptr = parse_hex_token(ptr, &reg_x);
+            ptr = parse_hex_token(ptr, &reg_y);
+            mon_bench(addr, len ? len : 1, (uint8_t)val, (uint8_t)reg_x, (uint8_t)reg_y);
+            break;
+            
+        case '#': /* Estadísticas */
+            switch (parse_option(ptr)) {
+                case 'R':
+                    mon_stats_reset();
+                    mon_ok();
+                    break;
+                case 'U':
+                    wait_show = !wait_show;
+                    mon_msg(wait_show ? MSG_USE_ON : MSG_USE_OFF);
+                    break;
+                default:
+                    mon_stats_show();
+                    break;
+            }
+            break;
+            
         case 'Q': /* Quit */
-            uart_puts("Saliendo del monitor...");
-            mon_newline();
+            mon_msg(MSG_QUIT);
             return MON_EXIT;
             
         case 'H':
@@ -896,7 +3200,7 @@ uint8_t monitor_process_cmd(char *cmd) {
             break;
             
         default:
-            mon_error("Comando desconocido. H=ayuda");
+            mon_error(MSG_E_UNKNOWN);
             break;
     }
     
@@ -912,7 +3216,7 @@ static void mon_read_line(void) {
     input_pos = 0;
     
     while (1) {
-        c = uart_getc();
+        c = mon_getc();
         
         /* Enter - fin de línea */
         if (c == '\r' || c == '\n') {
@@ -925,9 +3229,9 @@ static void mon_read_line(void) {
         if (c == 0x08 || c == 0x7F) {
             if (input_pos > 0) {
                 input_pos--;
-                uart_putc(0x08); /* Cursor atrás */
-                uart_putc(' ');  /* Borrar carácter */
-                uart_putc(0x08); /* Cursor atrás */
+                mon_putc(0x08); /* Cursor atrás */
+                mon_putc(' ');  /* Borrar carácter */
+                mon_putc(0x08); /* Cursor atrás */
             }
             continue;
         }
@@ -936,7 +3240,7 @@ static void mon_read_line(void) {
         if (c == 0x1B) {
             input_pos = 0;
             input_buffer[0] = '\0';
-            uart_puts(" [ESC]");
+            mon_puts(" [ESC]");
             mon_newline();
             return;
         }
@@ -944,7 +3248,7 @@ static void mon_read_line(void) {
         /* Carácter normal */
         if (input_pos < MON_BUFFER_SIZE - 1 && c >= 0x20 && c < 0x7F) {
             input_buffer[input_pos++] = c;
-            uart_putc(c); /* Echo */
+            mon_putc(c); /* Echo */
         }
     }
 }
@@ -953,30 +3257,53 @@ static void mon_read_line(void) {
  * FUNCIONES PRINCIPALES
  * ============================================ */
 
-void monitor_init(void) {
+uint8_t monitor_init(void) {
     input_pos = 0;
-    last_addr = 0x0200;
+    rx_count = 0;
+    mon_stats_reset();
+    mon_vec_reset();
+    
+    if (mon_warm_check()) {
+        boot_state = MON_BOOT_WARM;
+    } else {
+        boot_state = MON_BOOT_COLD;
+        last_addr = 0x0200;
+        memset(mon_regions, 0, sizeof(mon_regions));
+        mon_warm_seal();
+    }
+    return boot_state;
 }
 
 void monitor_run(void) {
     uint8_t result;
     
-    mon_newline();
-    uart_puts("================================");
-    mon_newline();
-    uart_puts("  MONITOR 6502 v1.0");
-    mon_newline();
-    uart_puts("  Tang Nano 9K @ 3.375 MHz");
-    mon_newline();
-    uart_puts("================================");
-    mon_newline();
-    uart_puts("Escribe H para ayuda");
+    mon_vec_reset();
+    
+    /* Banner completo solo en frío */
+    if (boot_state == MON_BOOT_COLD) {
+        mon_msg(MSG_BANNER);
+    } else if (boot_state == MON_BOOT_WARM) {
+        mon_newline();
+        mon_msg(MSG_WARM);
+        mon_print_dec(warm_kept);
+        mon_msg(MSG_WARM_KEPT);
+        mon_print_dec(warm_dropped);
+        mon_msg(MSG_WARM_DROPPED);
+    } else {
+        mon_newline();
+        mon_msg(MSG_RESTARTED);
+    }
+    boot_state = MON_BOOT_RESTART;
     
     while (1) {
         mon_prompt();
         mon_read_line();
         
+        memset(&wait_cmd, 0, sizeof(wait_cmd));
+        tx_ready_lo = 0;
+        rx_ready_lo = 0;
         result = monitor_process_cmd(input_buffer);
+        mon_wait_end();
         
         if (result == MON_EXIT) {
             break;
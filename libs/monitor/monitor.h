@@ -31,14 +31,28 @@
 /* Estructura para pasar código a ejecutar */
 typedef void (*code_ptr)(void);
 
+/* Vectores de interrupción en RAM (ver mon_vectors.s) */
+#define MON_VEC_NMI      0
+#define MON_VEC_IRQ      1
+#define MON_VEC_BRK      2
+#define MON_VEC_BASE     0x3A00   /* NMI=$3A00, IRQ=$3A02, BRK=$3A04 */
+#define MON_VEC_LOCK     0x3A06   /* Bit 7 a 1: NMI ignorado (ver mon_vectors.s) */
+
 /* ============================================
  * FUNCIONES PRINCIPALES
  * ============================================ */
 
+/* Tipo de arranque (monitor_init) */
+#define MON_BOOT_COLD    0        /* RAM del monitor sin firma válida */
+#define MON_BOOT_WARM    1        /* Regiones y last_addr conservados */
+
 /**
- * Inicializar el monitor
+ * Inicializar el monitor tras un reset
+ * Si el bloque de arranque en caliente (NOINIT) es válido conserva las
+ * regiones cuyo CRC coincide; si no, lo inicializa en frío
+ * @return MON_BOOT_COLD o MON_BOOT_WARM
  */
-void monitor_init(void);
+uint8_t monitor_init(void);
 
 /**
  * Ejecutar el monitor (bucle principal)
@@ -67,11 +81,21 @@ uint8_t mon_read_byte(uint16_t addr);
  */
 void mon_write_byte(uint16_t addr, uint8_t value);
 
+/* Modos de dump */
+#define MON_DUMP_COLLAPSE  0x00   /* Filas repetidas -> '*' (por defecto) */
+#define MON_DUMP_ALL       0x01   /* Mostrar todas las filas */
+#define MON_DUMP_SPARSE    0x02   /* Saltar filas enteras de $00 o $FF */
+
 /**
- * Dump de memoria en formato hex
+ * Dump de memoria en formato hex (colapsa filas repetidas)
  */
 void mon_dump(uint16_t addr, uint16_t len);
 
+/**
+ * Dump de memoria con modo MON_DUMP_*
+ */
+void mon_dump_ex(uint16_t addr, uint16_t len, uint8_t mode);
+
 /**
  * Llenar memoria con un valor
  */
@@ -111,4 +135,42 @@ void mon_newline(void);
  */
 void mon_execute(uint16_t addr);
 
+/* ============================================
+ * VECTORES DE INTERRUPCIÓN EN RAM
+ * ============================================ */
+
+/**
+ * Instalar un manejador de NMI, IRQ o BRK sin que una interrupción vea
+ * el vector a medio escribir (un NMI durante la escritura se ignora)
+ * @param vec MON_VEC_NMI, MON_VEC_IRQ o MON_VEC_BRK
+ * @param handler Rutina que termina en RTI o en JMP (anterior)
+ * @return Manejador anterior, para encadenarlo
+ */
+uint16_t mon_vec_install(uint8_t vec, code_ptr handler);
+
+/**
+ * Restaurar los vectores por defecto (RTI)
+ * El monitor lo llama al iniciar y al recuperar el control tras G
+ */
+void mon_vec_reset(void);
+
+/* ============================================
+ * REGISTRO DE REGIONES DE RAM
+ * ============================================ */
+
+/**
+ * Registrar un rango de RAM con nombre (hasta 8 caracteres)
+ * S, V, I y U lo dan por ocupado sin leerlo. Las regiones que solape
+ * se liberan (el contenido anterior queda sobrescrito).
+ * @param entry Punto de entrada si es un programa (lo lista N), 0 = datos
+ * @return MON_OK, o MON_ERROR si la tabla está llena o len es 0
+ */
+uint8_t mon_region_add(const char *name, uint16_t addr, uint16_t len, uint16_t entry);
+
+/**
+ * Liberar la región que contiene 'addr'
+ * @return MON_OK, o MON_ERROR si no hay ninguna
+ */
+uint8_t mon_region_free(uint16_t addr);
+
 #endif /* MONITOR_H */
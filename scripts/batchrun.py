@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""
+Ejecutor de pruebas por lotes con el comando @ del monitor
+
+Para cada binario de un directorio (en orden alfabético):
+  1. lo sube con L addr (hex) y comprueba los bytes cargados
+  2. lo ejecuta con '@ addr n celda' (con S, paso a paso)
+  3. captura la salida entre STX y el ETX que precede a la línea
+     "@ss cc tttttttt" (estado, código de salida, ciclos), así la prueba
+     puede emitir $02 y $03
+
+Una prueba pasa si termina con RTS (estado 00), el código de salida es el
+esperado y, si existe <nombre>.out junto al binario, la salida coincide.
+Una prueba que no responde o no se carga cuenta como fallo y el monitor
+se resincroniza antes de la siguiente.
+Funciona con la placa (pyserial) o con la ROM en el emulador.
+"""
+
+import argparse
+import re
+import sys
+import time
+from pathlib import Path
+
+STX = b'\x02'
+ETX = b'\x03'
+PROMPT = b'\r\n>'
+LINE_BYTES = 16
+
+STATUS = {0x00: 'fin', 0x01: 'BRK', 0x02: 'vigilante', 0x03: 'salto fuera de RAM'}
+
+LOADED_RE = re.compile(rb'Cargados ([0-9A-F]{4}) bytes')
+RESULT_RE = re.compile(rb'\x03@([0-9A-F]{2}) ([0-9A-F]{2}) ([0-9A-F]{8})\r\n\r\n>\Z')
+
+# Ciclos de emulador por cada 1000 del vigilante (a toda velocidad), con
+# margen para la carga y la salida por la UART
+EMU_WATCHDOG_FACTOR = 2000
+EMU_WATCHDOG_MARGIN = 2_000_000
+
+
+def parse_int(value):
+    try:
+        return int(value, 0)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"Valor inválido: '{value}'")
+
+
+class TargetError(RuntimeError):
+    """El monitor no respondió como se esperaba (la prueba falla, la serie sigue)"""
+
+
+def ends(out, until, start=0):
+    """out[start:] termina en 'until' (bytes o expresión anclada con \\Z)"""
+    if isinstance(until, bytes):
+        return len(out) - start >= len(until) and out.endswith(until)
+    return out.endswith(PROMPT) and until.search(out, start) is not None
+
+
+# ============================================
+# DESTINOS
+# ============================================
+
+class SerialTarget:
+    """Placa real por un puerto serie o un pseudo-terminal"""
+
+    def __init__(self, port, baud, timeout):
+        try:
+            import serial
+        except ImportError:
+            raise RuntimeError("Falta pyserial (pip install pyserial)")
+        self.port = serial.Serial(port, baud, timeout=timeout)
+        self.port.reset_input_buffer()
+        self.send(b'\r', PROMPT)
+
+    def send(self, data, until, cycles=None):
+        """Enviar 'data' y leer hasta 'until' (incluido)"""
+        if data:
+            self.port.write(data)
+        out = b''
+        while True:
+            part = self.port.read_until(until if isinstance(until, bytes) else PROMPT)
+            out += part
+            if ends(out, until):
+                return out
+            if not part.endswith(PROMPT):
+                raise TargetError(f"TIMEOUT esperando {getattr(until, 'pattern', until)!r}")
+
+    def resync(self):
+        """Cerrar una carga a medias y cancelar la línea; esperar el prompt"""
+        self.port.write(b'.\x1b\r')
+        time.sleep(0.2)
+        self.port.reset_input_buffer()
+        self.port.write(b'\r')
+        if not self.port.read_until(PROMPT).endswith(PROMPT):
+            raise RuntimeError("Sin respuesta del monitor; hay que reiniciar la placa")
+
+
+class EmuTarget:
+    """La ROM en emu6502.py"""
+
+    def __init__(self, rom, baud, max_cycles):
+        from emu6502 import System, Uart, load_rom
+        self.max_cycles = max_cycles
+        self.uart = Uart(baud=baud)
+        self.system = System(load_rom(rom), self.uart)
+        self.system.reset()
+        self.send(b'', PROMPT)
+
+    def send(self, data, until, cycles=None):
+        log = self.uart.tx_log
+        mark = len(log)
+        if data:
+            self.uart.feed(data)
+        reason = self.system.run(max_cycles=self.system.cycles + (cycles or self.max_cycles),
+                                 until=lambda s: len(log) > mark and ends(log, until, mark))
+        if reason != 'until':
+            raise TargetError(f"{'TIMEOUT' if reason == 'limit' else reason} "
+                              f"esperando {getattr(until, 'pattern', until)!r}")
+        return bytes(log[mark:])
+
+    def resync(self):
+        """Un programa colgado no suelta la CPU: reset (arranque en caliente)"""
+        self.uart.pending.clear()
+        self.uart.rx.clear()
+        self.system.reset()
+        self.send(b'', PROMPT)
+
+
+# ============================================
+# PRUEBAS
+# ============================================
+
+def upload(target, image, addr):
+    target.send(f"L {addr:04X}\r".encode('ascii'), b':')
+    for i in range(0, len(image), LINE_BYTES):
+        line = ' '.join(f"{b:02X}" for b in image[i:i + LINE_BYTES])
+        target.send(line.encode('ascii') + b'\r', b':')
+    out = target.send(b'.', PROMPT)
+    m = LOADED_RE.search(out)
+    if not m or int(m.group(1), 16) != len(image):
+        raise TargetError(f"carga incompleta: {out!r}")
+
+
+def run_test(target, path, args):
+    """Retorna (correcta, detalle)"""
+    image = path.read_bytes()
+    if not image or args.addr + len(image) - 1 > args.ram_end:
+        return False, f"tamaño inválido ({len(image)} bytes)"
+    upload(target, image, args.addr)
+
+    cmd = f"@ {args.addr:04X} {args.watchdog:X} {args.cell:X}{' S' if args.step else ''}\r"
+    limit = None
+    if args.watchdog and not args.step:
+        limit = args.watchdog * EMU_WATCHDOG_FACTOR + EMU_WATCHDOG_MARGIN
+    out = target.send(cmd.encode('ascii'), RESULT_RE, limit)
+    start = out.find(STX)
+    m = RESULT_RE.search(out)
+    if start < 0 or not m:
+        return False, f"respuesta no reconocida: {out!r}"
+    output = out[start + 1:m.start()]
+    status, code, cycles = (int(g, 16) for g in m.groups())
+
+    expected = path.with_suffix('.out')
+    detail = f"código ${code:02X}, ${cycles:08X} ciclos"
+    if status != 0x00:
+        return False, f"{STATUS.get(status, f'estado ${status:02X}')}, {detail}"
+    if code != args.expect:
+        return False, f"{detail} (se esperaba ${args.expect:02X})"
+    if expected.exists():
+        want = expected.read_bytes().replace(b'\r\n', b'\n')
+        if output.replace(b'\r\n', b'\n') != want:
+            return False, f"{detail}, la salida no coincide con {expected.name}: {output!r}"
+    return True, detail
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='Ejecuta un directorio de binarios de prueba con el comando @ del monitor',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('tests', help='Directorio con los binarios (*.bin) y salidas esperadas (*.out)')
+    target_group = parser.add_mutually_exclusive_group(required=True)
+    target_group.add_argument('-p', '--port', help='Puerto serie o pseudo-terminal')
+    target_group.add_argument('--emu', metavar='ROM', help='Usar el emulador con esta ROM')
+    parser.add_argument('-b', '--baud', type=int, default=115200, help='Velocidad de la UART')
+    parser.add_argument('--addr', type=parse_int, default=0x0200, help='Dirección de carga y entrada')
+    parser.add_argument('--watchdog', type=parse_int, default=0x400,
+                        help='Presupuesto en miles de ciclos (0 = sin vigilante)')
+    parser.add_argument('--step', action='store_true',
+                        help='Paso a paso: el vigilante corta bucles infinitos (unas 100 veces más lento)')
+    parser.add_argument('--cell', type=parse_int, default=0, help='Celda con el código de salida (0 = A)')
+    parser.add_argument('--expect', type=parse_int, default=0, help='Código de salida correcto')
+    parser.add_argument('--ram-end', type=parse_int, default=0x39FF, help='Último byte de RAM libre')
+    parser.add_argument('--timeout', type=float, default=10.0, help='Segundos sin respuesta (placa)')
+    parser.add_argument('--max-cycles', type=int, default=500_000_000, help='Límite por paso (emulador)')
+    parser.add_argument('-x', '--stop', action='store_true', help='Parar en el primer fallo')
+    args = parser.parse_args()
+
+    try:
+        tests = sorted(Path(args.tests).glob('*.bin'))
+        if not tests:
+            raise ValueError(f"No hay binarios .bin en {args.tests}")
+        if args.emu:
+            target = EmuTarget(args.emu, args.baud, args.max_cycles)
+        else:
+            target = SerialTarget(args.port, args.baud, args.timeout)
+
+        passed = 0
+        for path in tests:
+            try:
+                ok, detail = run_test(target, path, args)
+            except TargetError as e:
+                ok, detail = False, str(e)
+                target.resync()
+            passed += ok
+            print(f"{'PASA ' if ok else 'FALLA'} {path.stem}: {detail}")
+            if not ok and args.stop:
+                break
+        print(f"{passed}/{len(tests)} pruebas correctas")
+    except Exception as e:
+        print(f"❌ Error: {e}")
+        exit(1)
+    sys.exit(0 if passed == len(tests) else 1)
@@ -5,9 +5,16 @@ Basado en bin2rom.py
 """
 
 import argparse
+import struct
 from pathlib import Path
 from datetime import datetime
 
+# Bundle de programas en ROM (leído por el comando P del monitor)
+BUNDLE_TRAILER = 4           # 'P','B', dir (lo, hi) justo antes de los vectores ($9FF6)
+BUNDLE_NAME_LEN = 8
+BUNDLE_RLE = 0x01
+BUNDLE_XIP = 0x02
+
 def format_vhdl_data(data, data_width, offset):
     """Formatea los datos para inicialización VHDL con un offset inicial"""
     elements = []
@@ -105,7 +112,116 @@ def generate_intel_hex(data, offset):
     hex_lines.append(":00000001FF")
     return "\n".join(hex_lines)
 
-def bin_to_rom(input_file, output_dir, rom_size, rom_name="rom", data_width=8, addr_width=None, fill_byte=0xFF, offset=0):
+def rle_compress(data):
+    """
+    Compresión RLE simple, decodificada por el monitor:
+      c < 0x80  -> copiar c+1 bytes literales
+      c >= 0x80 -> repetir el siguiente byte (c & 0x7F) + 3 veces
+    """
+    out = bytearray()
+    literal = bytearray()
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 130:
+            run += 1
+        if run >= 3:
+            while literal:
+                chunk = literal[:128]
+                out.append(len(chunk) - 1)
+                out += chunk
+                literal = literal[128:]
+            out += bytes([0x80 | (run - 3), data[i]])
+            i += run
+        else:
+            literal.append(data[i])
+            i += 1
+    while literal:
+        chunk = literal[:128]
+        out.append(len(chunk) - 1)
+        out += chunk
+        literal = literal[128:]
+    return bytes(out)
+
+def parse_program(spec, xip=False):
+    """Parsea 'NOMBRE:archivo.bin:dir' (dir = carga en RAM o posición en ROM si XIP)"""
+    parts = spec.split(':')
+    if len(parts) != 3:
+        raise argparse.ArgumentTypeError(f"Programa inválido: '{spec}'. Formato NOMBRE:archivo.bin:dir")
+    name = parts[0].upper()
+    if not name or len(name) > BUNDLE_NAME_LEN:
+        raise argparse.ArgumentTypeError(f"Nombre inválido: '{parts[0]}' (1-{BUNDLE_NAME_LEN} caracteres)")
+    return (name, parts[1], parse_int(parts[2]), xip)
+
+def build_bundle(rom, code_end, rom_base, programs, compress):
+    """
+    Añade programas y su directorio al espacio libre de la ROM.
+    Directorio: n_entradas + n * (nombre[8], src, almacenado, carga, len, flags)
+    """
+    limit = len(rom) - 6 - BUNDLE_TRAILER
+    if code_end > limit:
+        raise ValueError(f"El código ocupa la zona del directorio ({code_end} > {limit})")
+
+    used = [(0, code_end)]
+    entries = []
+
+    def reserve(start, size, what):
+        end = start + size
+        if start < code_end or end > limit:
+            raise ValueError(f"{what} no cabe en la ROM libre (${rom_base + code_end:04X}-${rom_base + limit - 1:04X})")
+        for (a, b) in used:
+            if start < b and a < end:
+                raise ValueError(f"{what} se solapa con otro bloque en ${rom_base + start:04X}")
+        used.append((start, end))
+
+    # XIP primero: van en la posición de ROM para la que fueron enlazados
+    for (name, path, addr, xip) in programs:
+        if not xip:
+            continue
+        data = Path(path).read_bytes()
+        pos = addr - rom_base
+        reserve(pos, len(data), name)
+        rom[pos:pos + len(data)] = data
+        entries.append((name, addr, len(data), addr, len(data), BUNDLE_XIP))
+
+    # Copiar-y-ejecutar: empaquetados a continuación del código
+    pos = code_end
+    for (name, path, load, xip) in programs:
+        if xip:
+            continue
+        data = Path(path).read_bytes()
+        stored, flags = data, 0
+        if compress:
+            packed = rle_compress(data)
+            if len(packed) < len(data):
+                stored, flags = packed, BUNDLE_RLE
+        while any(pos < b and a < pos + len(stored) for (a, b) in used):
+            pos = max(b for (a, b) in used if pos < b and a < pos + len(stored))
+        reserve(pos, len(stored), name)
+        rom[pos:pos + len(stored)] = stored
+        entries.append((name, rom_base + pos, len(stored), load, len(data), flags))
+        pos += len(stored)
+
+    directory = bytearray([len(entries)])
+    for (name, src, stored_len, load, length, flags) in entries:
+        directory += struct.pack('<8sHHHHB', name.encode('ascii'), src, stored_len, load, length, flags)
+    while any(pos < b and a < pos + len(directory) for (a, b) in used):
+        pos = max(b for (a, b) in used if pos < b and a < pos + len(directory))
+    reserve(pos, len(directory), "Directorio")
+    rom[pos:pos + len(directory)] = directory
+
+    trailer = len(rom) - 6 - BUNDLE_TRAILER
+    dir_addr = rom_base + pos
+    rom[trailer:trailer + 4] = bytes([ord('P'), ord('B'), dir_addr & 0xFF, dir_addr >> 8])
+
+    for (name, src, stored_len, load, length, flags) in entries:
+        mode = "XIP" if flags & BUNDLE_XIP else f"-> ${load:04X}" + (" RLE" if flags & BUNDLE_RLE else "")
+        print(f"  {name:<8} ${src:04X} {stored_len:5d}/{length:5d} bytes {mode}")
+    free = limit - sum(b - a for (a, b) in used)
+    print(f"  Directorio en ${dir_addr:04X}, {len(entries)} programas, {free} bytes libres")
+
+def bin_to_rom(input_file, output_dir, rom_size, rom_name="rom", data_width=8, addr_width=None, fill_byte=0xFF, offset=0,
+               programs=None, rom_base=0x8000, compress=False):
     """Convierte binario a múltiples formatos"""
     # Leer y ajustar datos
     
@@ -126,6 +242,12 @@ def bin_to_rom(input_file, output_dir, rom_size, rom_name="rom", data_width=8, a
         padded_data[-6:] = vectors
         print(f"  Vectores 6502 copiados a posiciones {rom_size-6}-{rom_size-1}")
 
+    # Programas de usuario en el espacio libre (el código termina antes de los vectores)
+    if programs:
+        code_end = data_len - 6
+        padded_data[code_end:rom_size - 6] = bytes([fill_byte] * (rom_size - 6 - code_end))
+        build_bundle(padded_data, code_end, rom_base, programs, compress)
+
     # Crear directorio
     output_dir = Path(output_dir)
     output_dir.mkdir(exist_ok=True)
@@ -171,6 +293,14 @@ if __name__ == "__main__":
                         help='Byte de relleno (ej: 0x00, 255)')
     parser.add_argument('--offset', type=parse_int, default=0,
                         help='Offset inicial en la salida Intel HEX (en bytes)')
+    parser.add_argument('--program', action='append', default=[], type=parse_program, metavar='NOMBRE:BIN:CARGA',
+                        help='Programa a copiar en RAM y ejecutar (comando P del monitor)')
+    parser.add_argument('--xip', action='append', default=[], type=lambda v: parse_program(v, xip=True),
+                        metavar='NOMBRE:BIN:DIR_ROM', help='Programa enlazado para ejecutarse desde ROM en DIR_ROM')
+    parser.add_argument('--compress', action='store_true',
+                        help='Comprimir con RLE los programas copiados a RAM')
+    parser.add_argument('--base', type=parse_int, default=0x8000,
+                        help='Dirección de la CPU donde empieza la ROM (para el bundle)')
 
     args = parser.parse_args()
 
@@ -183,7 +313,10 @@ if __name__ == "__main__":
             data_width=args.data_width,
             addr_width=args.addr_width,
             fill_byte=args.fill,
-            offset=args.offset
+            offset=args.offset,
+            programs=args.xip + args.program,
+            rom_base=args.base,
+            compress=args.compress
         )
     except Exception as e:
         print(f"❌ Error: {e}")
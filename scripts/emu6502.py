@@ -0,0 +1,900 @@
+#!/usr/bin/env python3
+"""
+Emulador 6502 del sistema Tang Nano 9K para ejecutar la ROM del monitor en el PC
+
+Modela:
+- CPU NMOS 6502 (instrucciones documentadas) con ciclos exactos, incluidas
+  las penalizaciones por cruce de página y por salto tomado
+- RAM $0000-$3FFF, ROM de 8 KB en $8000-$9FFF (espejada hasta $FFFF para
+  que los vectores $FFFA-$FFFF lleguen a $9FFA-$9FFF)
+- UART en $C020 (datos) / $C021 (estado), con temporización de línea opcional
+- Contador libre de ciclos de 32 bits en $C010-$C013 (comando J del
+  monitor): leer $C010 congela los tres bytes altos
+
+Además puede perfilar: cuántas veces se ejecutó cada dirección y cuántos
+ciclos consumió, durante una ejecución de G concreta o toda la sesión.
+"""
+
+import argparse
+import sys
+from collections import deque
+from pathlib import Path
+
+CPU_HZ = 3375000
+
+RAM_SIZE = 0x4000
+ROM_BASE = 0x8000
+ROM_SIZE = 0x2000
+IO_BASE = 0xC000
+IO_END = 0xC0FF
+
+COUNTER = 0xC010        # Debe coincidir con BENCH_COUNTER en mon_bench.s
+
+UART_DATA = 0xC020
+UART_STATUS = 0xC021
+UART_TX_READY = 0x01
+UART_RX_VALID = 0x02    # Debe coincidir con MON_UART_RX_VALID en monitor.c
+UART_PROMPTS = (b'\r\n>', b':')  # mon_prompt y los modos de carga L/U
+UART_IDLE_POLLS = 20000 # Sondeos sin actividad que cuentan como espera
+
+FLAG_C = 0x01
+FLAG_Z = 0x02
+FLAG_I = 0x04
+FLAG_D = 0x08
+FLAG_B = 0x10
+FLAG_U = 0x20
+FLAG_V = 0x40
+FLAG_N = 0x80
+
+# ============================================
+# TABLA DE INSTRUCCIONES
+# ============================================
+
+# (mnemónico, modo, ciclos, +1 si cruza página)
+OPCODES = {}
+
+
+def _op(code, mnem, mode, cycles, page=False):
+    OPCODES[code] = (mnem, mode, cycles, page)
+
+
+for _base, _m in ((0x00, 'ORA'), (0x20, 'AND'), (0x40, 'EOR'), (0x60, 'ADC'),
+                  (0xA0, 'LDA'), (0xC0, 'CMP'), (0xE0, 'SBC')):
+    _op(_base + 0x09, _m, 'imm', 2)
+    _op(_base + 0x05, _m, 'zp', 3)
+    _op(_base + 0x15, _m, 'zpx', 4)
+    _op(_base + 0x0D, _m, 'abs', 4)
+    _op(_base + 0x1D, _m, 'abx', 4, True)
+    _op(_base + 0x19, _m, 'aby', 4, True)
+    _op(_base + 0x01, _m, 'izx', 6)
+    _op(_base + 0x11, _m, 'izy', 5, True)
+
+_op(0x85, 'STA', 'zp', 3)
+_op(0x95, 'STA', 'zpx', 4)
+_op(0x8D, 'STA', 'abs', 4)
+_op(0x9D, 'STA', 'abx', 5)
+_op(0x99, 'STA', 'aby', 5)
+_op(0x81, 'STA', 'izx', 6)
+_op(0x91, 'STA', 'izy', 6)
+
+for _base, _m in ((0x00, 'ASL'), (0x20, 'ROL'), (0x40, 'LSR'), (0x60, 'ROR')):
+    _op(_base + 0x0A, _m, 'acc', 2)
+    _op(_base + 0x06, _m, 'zp', 5)
+    _op(_base + 0x16, _m, 'zpx', 6)
+    _op(_base + 0x0E, _m, 'abs', 6)
+    _op(_base + 0x1E, _m, 'abx', 7)
+
+for _base, _m in ((0xC0, 'DEC'), (0xE0, 'INC')):
+    _op(_base + 0x06, _m, 'zp', 5)
+    _op(_base + 0x16, _m, 'zpx', 6)
+    _op(_base + 0x0E, _m, 'abs', 6)
+    _op(_base + 0x1E, _m, 'abx', 7)
+
+for _code, _m in ((0x10, 'BPL'), (0x30, 'BMI'), (0x50, 'BVC'), (0x70, 'BVS'),
+                  (0x90, 'BCC'), (0xB0, 'BCS'), (0xD0, 'BNE'), (0xF0, 'BEQ')):
+    _op(_code, _m, 'rel', 2)
+
+for _code, _m, _c in ((0x00, 'BRK', 7), (0x40, 'RTI', 6), (0x60, 'RTS', 6),
+                      (0x08, 'PHP', 3), (0x28, 'PLP', 4), (0x48, 'PHA', 3), (0x68, 'PLA', 4),
+                      (0x18, 'CLC', 2), (0x38, 'SEC', 2), (0x58, 'CLI', 2), (0x78, 'SEI', 2),
+                      (0xB8, 'CLV', 2), (0xD8, 'CLD', 2), (0xF8, 'SED', 2), (0xEA, 'NOP', 2),
+                      (0xAA, 'TAX', 2), (0xA8, 'TAY', 2), (0xBA, 'TSX', 2), (0x8A, 'TXA', 2),
+                      (0x9A, 'TXS', 2), (0x98, 'TYA', 2), (0xE8, 'INX', 2), (0xC8, 'INY', 2),
+                      (0xCA, 'DEX', 2), (0x88, 'DEY', 2)):
+    _op(_code, _m, 'imp', _c)
+
+_op(0x24, 'BIT', 'zp', 3)
+_op(0x2C, 'BIT', 'abs', 4)
+_op(0x4C, 'JMP', 'abs', 3)
+_op(0x6C, 'JMP', 'ind', 5)
+_op(0x20, 'JSR', 'abs', 6)
+_op(0xE0, 'CPX', 'imm', 2)
+_op(0xE4, 'CPX', 'zp', 3)
+_op(0xEC, 'CPX', 'abs', 4)
+_op(0xC0, 'CPY', 'imm', 2)
+_op(0xC4, 'CPY', 'zp', 3)
+_op(0xCC, 'CPY', 'abs', 4)
+_op(0xA2, 'LDX', 'imm', 2)
+_op(0xA6, 'LDX', 'zp', 3)
+_op(0xB6, 'LDX', 'zpy', 4)
+_op(0xAE, 'LDX', 'abs', 4)
+_op(0xBE, 'LDX', 'aby', 4, True)
+_op(0xA0, 'LDY', 'imm', 2)
+_op(0xA4, 'LDY', 'zp', 3)
+_op(0xB4, 'LDY', 'zpx', 4)
+_op(0xAC, 'LDY', 'abs', 4)
+_op(0xBC, 'LDY', 'abx', 4, True)
+_op(0x86, 'STX', 'zp', 3)
+_op(0x96, 'STX', 'zpy', 4)
+_op(0x8E, 'STX', 'abs', 4)
+_op(0x84, 'STY', 'zp', 3)
+_op(0x94, 'STY', 'zpx', 4)
+_op(0x8C, 'STY', 'abs', 4)
+
+MODE_LEN = {'imp': 1, 'acc': 1, 'imm': 2, 'zp': 2, 'zpx': 2, 'zpy': 2, 'izx': 2,
+            'izy': 2, 'rel': 2, 'abs': 3, 'abx': 3, 'aby': 3, 'ind': 3}
+
+ILLEGAL = ('???', 'imp', 2, False)
+
+
+def disassemble(read, addr):
+    """Desensamblar una instrucción. Retorna (texto, longitud)"""
+    mnem, mode, _, _ = OPCODES.get(read(addr), ILLEGAL)
+    length = MODE_LEN[mode]
+    lo = read((addr + 1) & 0xFFFF)
+    word = lo | (read((addr + 2) & 0xFFFF) << 8)
+    operand = {
+        'imp': '', 'acc': ' A', 'imm': f' #${lo:02X}', 'zp': f' ${lo:02X}',
+        'zpx': f' ${lo:02X},X', 'zpy': f' ${lo:02X},Y', 'izx': f' (${lo:02X},X)',
+        'izy': f' (${lo:02X}),Y', 'abs': f' ${word:04X}', 'abx': f' ${word:04X},X',
+        'aby': f' ${word:04X},Y', 'ind': f' (${word:04X})',
+        'rel': f' ${(addr + 2 + (lo - 256 if lo & 0x80 else lo)) & 0xFFFF:04X}',
+    }[mode]
+    return mnem + operand, length
+
+
+# ============================================
+# UART
+# ============================================
+
+class Uart:
+    """
+    UART con cola de recepción. Las líneas de entrada se entregan una a una
+    cuando la CPU está esperando datos (como al teclear tras el prompt): la
+    salida acaba en uno de 'prompts' y la CPU sondea el estado con el
+    transmisor libre sin escribir nada (mon_putc escribe al primer sondeo
+    libre; solo una espera de entrada repite). Otras esperas de tecla (O)
+    reciben la línea tras UART_IDLE_POLLS sondeos así. Con baud > 0 cada
+    byte tarda 10 bits de línea en TX y en RX.
+
+    stream() modela en cambio un emisor que no espera a la CPU: los bytes
+    llegan a ritmo de línea a un registro de un byte y, si la CPU no lo
+    ha leído a tiempo, el nuevo se pierde (desborde).
+    """
+
+    def __init__(self, baud=115200, cpu_hz=CPU_HZ, out=None,
+                 tx_ready=UART_TX_READY, rx_valid=UART_RX_VALID, prompts=UART_PROMPTS):
+        self.char_cycles = (cpu_hz * 10) // baud if baud else 0
+        self.prompts = prompts
+        self.out = out
+        self.tx_ready_mask = tx_ready
+        self.rx_valid_mask = rx_valid
+        self.rx = deque()
+        self.pending = deque()
+        self.tx_log = bytearray()
+        self.tx_times = None    # Lista de ciclos por byte enviado si no es None
+        self.tx_busy_until = 0
+        self.rx_ready_at = 0
+        self.idle_polls = 0
+        self.ready_polls = 0    # Sondeos con TX libre desde la última escritura
+        self.line = deque()     # (ciclo de llegada, byte) de stream()
+        self.hold = None        # Registro de recepción de stream()
+        self.overruns = 0
+        self.last_read = 0      # Ciclo de la última lectura de stream()
+
+    def feed(self, data):
+        """Encolar una línea (bytes) para enviarla cuando la CPU la pida"""
+        self.pending.append(bytes(data))
+
+    def stream(self, data, cycle):
+        """Enviar bytes a ritmo de línea desde 'cycle', los lea o no la CPU"""
+        if not self.char_cycles:
+            raise ValueError("stream() necesita baud > 0")
+        at = max(cycle, self.line[-1][0]) if self.line else cycle
+        for value in data:
+            at += self.char_cycles
+            self.line.append((at, value))
+
+    def _arrive(self, cycle):
+        while self.line and self.line[0][0] <= cycle:
+            _, value = self.line.popleft()
+            if self.hold is None:
+                self.hold = value
+            else:
+                self.overruns += 1
+
+    def status(self, cycle):
+        value = 0
+        if cycle >= self.tx_busy_until:
+            value |= self.tx_ready_mask
+            self.ready_polls += 1
+        self._arrive(cycle)
+        if self.hold is not None:
+            self.idle_polls = 0
+            return value | self.rx_valid_mask
+        if not self.rx and self.pending and not self.line and self.wants_input():
+            self.rx.extend(self.pending.popleft())
+            self.rx_ready_at = cycle + self.char_cycles
+        if self.rx and cycle >= self.rx_ready_at:
+            value |= self.rx_valid_mask
+            self.idle_polls = 0
+        elif not self.rx:
+            self.idle_polls += 1
+        return value
+
+    def wants_input(self):
+        """La CPU espera una línea: sondea sin escribir tras un prompt (o mucho rato)"""
+        return self.ready_polls >= 2 and (self.tx_log.endswith(self.prompts)
+                                          or self.ready_polls > UART_IDLE_POLLS)
+
+    def read_data(self, cycle):
+        self._arrive(cycle)
+        if self.hold is not None:
+            value, self.hold = self.hold, None
+            self.last_read = cycle
+            return value
+        if not self.rx or cycle < self.rx_ready_at:
+            return 0
+        self.rx_ready_at = cycle + self.char_cycles
+        return self.rx.popleft()
+
+    def write_data(self, cycle, value):
+        self.tx_busy_until = cycle + self.char_cycles
+        self.ready_polls = 0
+        self.tx_log.append(value)
+        if self.tx_times is not None:
+            self.tx_times.append(cycle)
+        self.idle_polls = 0
+        if self.out is not None:
+            self.out.write(bytes([value]))
+            self.out.flush()
+
+    def waiting(self):
+        """La CPU lleva tiempo sondeando sin datos y no queda entrada"""
+        return (not self.rx and not self.pending and not self.line and self.hold is None
+                and self.idle_polls > UART_IDLE_POLLS)
+
+
+# ============================================
+# SISTEMA (CPU + MEMORIA + E/S)
+# ============================================
+
+def load_rom(path):
+    """
+    Imagen de 8 KB: output/rom.bin tal cual, o build/main.bin (código +
+    vectores) rellenado con $FF y los vectores al final, como bin2rom3.py
+    """
+    data = Path(path).read_bytes()
+    if len(data) == ROM_SIZE:
+        return data
+    if not 6 <= len(data) < ROM_SIZE:
+        raise ValueError(f"{path}: {len(data)} bytes no es una ROM ni un main.bin")
+    rom = bytearray(data[:-6]) + bytes([0xFF] * (ROM_SIZE - len(data)))
+    return bytes(rom + data[-6:])
+
+
+class System:
+    def __init__(self, rom, uart=None):
+        if len(rom) != ROM_SIZE:
+            raise ValueError(f"La ROM debe ocupar {ROM_SIZE} bytes (usar output/rom.bin)")
+        self.ram = bytearray(RAM_SIZE)
+        self.rom = bytes(rom)
+        self.uart = uart or Uart()
+        self.io = bytearray(0x100)
+        self.a = self.x = self.y = 0
+        self.s = 0xFD
+        self.p = FLAG_I | FLAG_U
+        self.pc = 0
+        self.cycles = 0
+        self.instructions = 0
+        self.illegal = 0
+        self.prev_s = self.s
+        self.counter_latch = 0
+        self.hooks = []         # Llamados con (system, pc, ciclos) tras cada instrucción
+
+    # --- Bus ---
+
+    def read(self, addr):
+        if addr < RAM_SIZE:
+            return self.ram[addr]
+        if IO_BASE <= addr <= IO_END:
+            if addr == UART_STATUS:
+                return self.uart.status(self.cycles)
+            if addr == UART_DATA:
+                return self.uart.read_data(self.cycles)
+            if addr == COUNTER:
+                self.counter_latch = self.cycles & 0xFFFFFFFF
+                return self.counter_latch & 0xFF
+            if COUNTER < addr <= COUNTER + 3:
+                return (self.counter_latch >> (8 * (addr - COUNTER))) & 0xFF
+            return self.io[addr & 0xFF]
+        if addr >= ROM_BASE:
+            return self.rom[addr & (ROM_SIZE - 1)]
+        return 0xFF
+
+    def peek(self, addr):
+        """Lectura sin efectos laterales (para desensamblar)"""
+        if addr < RAM_SIZE:
+            return self.ram[addr]
+        if ROM_BASE <= addr and not (IO_BASE <= addr <= IO_END):
+            return self.rom[addr & (ROM_SIZE - 1)]
+        return 0xFF
+
+    def write(self, addr, value):
+        if addr < RAM_SIZE:
+            self.ram[addr] = value
+        elif IO_BASE <= addr <= IO_END:
+            if addr == UART_DATA:
+                self.uart.write_data(self.cycles, value)
+            else:
+                self.io[addr & 0xFF] = value
+
+    def load(self, addr, data):
+        """Cargar una imagen en RAM (p. ej. un programa o una instantánea)"""
+        self.ram[addr:addr + len(data)] = data
+
+    def read16(self, addr):
+        return self.read(addr) | (self.read((addr + 1) & 0xFFFF) << 8)
+
+    # --- Pila ---
+
+    def push(self, value):
+        self.ram[0x100 | self.s] = value
+        self.s = (self.s - 1) & 0xFF
+
+    def pull(self):
+        self.s = (self.s + 1) & 0xFF
+        return self.ram[0x100 | self.s]
+
+    # --- Control ---
+
+    def reset(self):
+        self.s = 0xFD
+        self.p = FLAG_I | FLAG_U
+        self.pc = self.read16(0xFFFC)
+        self.cycles += 7
+
+    def _nz(self, value):
+        self.p = (self.p & ~(FLAG_N | FLAG_Z)) | (value & FLAG_N) | (FLAG_Z if value == 0 else 0)
+        return value
+
+    def _adc(self, value):
+        carry = self.p & FLAG_C
+        if self.p & FLAG_D:
+            lo = (self.a & 0x0F) + (value & 0x0F) + carry
+            if lo > 9:
+                lo += 6
+            hi = (self.a >> 4) + (value >> 4) + (1 if lo > 0x0F else 0)
+            binary = self.a + value + carry
+            self.p &= ~(FLAG_C | FLAG_V | FLAG_N | FLAG_Z)
+            if not (binary & 0xFF):
+                self.p |= FLAG_Z
+            if hi & 0x08:
+                self.p |= FLAG_N
+            if ~(self.a ^ value) & (self.a ^ (hi << 4)) & 0x80:
+                self.p |= FLAG_V
+            if hi > 9:
+                hi += 6
+            if hi > 0x0F:
+                self.p |= FLAG_C
+            self.a = ((hi << 4) | (lo & 0x0F)) & 0xFF
+            return
+        result = self.a + value + carry
+        self.p &= ~(FLAG_C | FLAG_V)
+        if result > 0xFF:
+            self.p |= FLAG_C
+        if ~(self.a ^ value) & (self.a ^ result) & 0x80:
+            self.p |= FLAG_V
+        self.a = self._nz(result & 0xFF)
+
+    def _sbc(self, value):
+        if self.p & FLAG_D:
+            borrow = 0 if self.p & FLAG_C else 1
+            binary = self.a - value - borrow
+            lo = (self.a & 0x0F) - (value & 0x0F) - borrow
+            hi = (self.a >> 4) - (value >> 4)
+            if lo < 0:
+                lo -= 6
+                hi -= 1
+            if hi < 0:
+                hi -= 6
+            self.p &= ~(FLAG_C | FLAG_V | FLAG_N | FLAG_Z)
+            if binary >= 0:
+                self.p |= FLAG_C
+            if (self.a ^ value) & (self.a ^ binary) & 0x80:
+                self.p |= FLAG_V
+            self._nz_keep(binary & 0xFF)
+            self.a = ((hi << 4) | (lo & 0x0F)) & 0xFF
+            return
+        self._adc(value ^ 0xFF)
+
+    def _nz_keep(self, value):
+        if value & 0x80:
+            self.p |= FLAG_N
+        if value == 0:
+            self.p |= FLAG_Z
+
+    def _compare(self, reg, value):
+        result = reg - value
+        self.p = (self.p & ~FLAG_C) | (FLAG_C if result >= 0 else 0)
+        self._nz(result & 0xFF)
+
+    def irq(self, brk=False):
+        pc = (self.pc + 2) & 0xFFFF if brk else self.pc
+        self.push(pc >> 8)
+        self.push(pc & 0xFF)
+        self.push(self.p | FLAG_U | (FLAG_B if brk else 0))
+        self.p |= FLAG_I
+        self.pc = self.read16(0xFFFE)
+
+    def step(self):
+        """Ejecutar una instrucción. Retorna los ciclos consumidos"""
+        pc = self.pc
+        self.prev_s = self.s
+        op = self.read(pc)
+        mnem, mode, cycles, page = OPCODES.get(op, ILLEGAL)
+
+        # Dirección efectiva
+        addr = None
+        if mode == 'imm':
+            addr = (pc + 1) & 0xFFFF
+        elif mode == 'zp':
+            addr = self.read(pc + 1)
+        elif mode == 'zpx':
+            addr = (self.read(pc + 1) + self.x) & 0xFF
+        elif mode == 'zpy':
+            addr = (self.read(pc + 1) + self.y) & 0xFF
+        elif mode == 'abs':
+            addr = self.read16(pc + 1)
+        elif mode in ('abx', 'aby'):
+            base = self.read16(pc + 1)
+            addr = (base + (self.x if mode == 'abx' else self.y)) & 0xFFFF
+            if page and (base ^ addr) & 0xFF00:
+                cycles += 1
+        elif mode == 'izx':
+            zp = (self.read(pc + 1) + self.x) & 0xFF
+            addr = self.ram[zp] | (self.ram[(zp + 1) & 0xFF] << 8)
+        elif mode == 'izy':
+            zp = self.read(pc + 1)
+            base = self.ram[zp] | (self.ram[(zp + 1) & 0xFF] << 8)
+            addr = (base + self.y) & 0xFFFF
+            if page and (base ^ addr) & 0xFF00:
+                cycles += 1
+        elif mode == 'ind':
+            ptr = self.read16(pc + 1)
+            # Bug del 6502: el puntero no cruza de página
+            addr = self.read(ptr) | (self.read((ptr & 0xFF00) | ((ptr + 1) & 0xFF)) << 8)
+
+        next_pc = (pc + MODE_LEN[mode]) & 0xFFFF
+
+        if mnem == 'LDA':
+            self.a = self._nz(self.read(addr))
+        elif mnem == 'LDX':
+            self.x = self._nz(self.read(addr))
+        elif mnem == 'LDY':
+            self.y = self._nz(self.read(addr))
+        elif mnem == 'STA':
+            self.write(addr, self.a)
+        elif mnem == 'STX':
+            self.write(addr, self.x)
+        elif mnem == 'STY':
+            self.write(addr, self.y)
+        elif mode == 'rel':
+            taken = {
+                'BPL': not self.p & FLAG_N, 'BMI': self.p & FLAG_N,
+                'BVC': not self.p & FLAG_V, 'BVS': self.p & FLAG_V,
+                'BCC': not self.p & FLAG_C, 'BCS': self.p & FLAG_C,
+                'BNE': not self.p & FLAG_Z, 'BEQ': self.p & FLAG_Z,
+            }[mnem]
+            if taken:
+                off = self.read(pc + 1)
+                target = (next_pc + (off - 256 if off & 0x80 else off)) & 0xFFFF
+                cycles += 2 if (target ^ next_pc) & 0xFF00 else 1
+                next_pc = target
+        elif mnem in ('ORA', 'AND', 'EOR'):
+            value = self.read(addr)
+            if mnem == 'ORA':
+                self.a = self._nz(self.a | value)
+            elif mnem == 'AND':
+                self.a = self._nz(self.a & value)
+            else:
+                self.a = self._nz(self.a ^ value)
+        elif mnem == 'ADC':
+            self._adc(self.read(addr))
+        elif mnem == 'SBC':
+            self._sbc(self.read(addr))
+        elif mnem == 'CMP':
+            self._compare(self.a, self.read(addr))
+        elif mnem == 'CPX':
+            self._compare(self.x, self.read(addr))
+        elif mnem == 'CPY':
+            self._compare(self.y, self.read(addr))
+        elif mnem == 'BIT':
+            value = self.read(addr)
+            self.p = (self.p & ~(FLAG_N | FLAG_V | FLAG_Z)) | (value & (FLAG_N | FLAG_V)) | \
+                     (FLAG_Z if not (self.a & value) else 0)
+        elif mnem in ('ASL', 'LSR', 'ROL', 'ROR', 'INC', 'DEC'):
+            value = self.a if mode == 'acc' else self.read(addr)
+            if mnem == 'ASL':
+                self.p = (self.p & ~FLAG_C) | (value >> 7)
+                value = (value << 1) & 0xFF
+            elif mnem == 'LSR':
+                self.p = (self.p & ~FLAG_C) | (value & 1)
+                value >>= 1
+            elif mnem == 'ROL':
+                carry = self.p & FLAG_C
+                self.p = (self.p & ~FLAG_C) | (value >> 7)
+                value = ((value << 1) | carry) & 0xFF
+            elif mnem == 'ROR':
+                carry = self.p & FLAG_C
+                self.p = (self.p & ~FLAG_C) | (value & 1)
+                value = (value >> 1) | (carry << 7)
+            elif mnem == 'INC':
+                value = (value + 1) & 0xFF
+            else:
+                value = (value - 1) & 0xFF
+            self._nz(value)
+            if mode == 'acc':
+                self.a = value
+            else:
+                self.write(addr, value)
+        elif mnem == 'JMP':
+            next_pc = addr
+        elif mnem == 'JSR':
+            ret = (pc + 2) & 0xFFFF
+            self.push(ret >> 8)
+            self.push(ret & 0xFF)
+            next_pc = addr
+        elif mnem == 'RTS':
+            lo = self.pull()
+            next_pc = (((self.pull() << 8) | lo) + 1) & 0xFFFF
+        elif mnem == 'RTI':
+            self.p = (self.pull() & ~FLAG_B) | FLAG_U
+            lo = self.pull()
+            next_pc = (self.pull() << 8) | lo
+        elif mnem == 'BRK':
+            self.pc = pc
+            self.irq(brk=True)
+            next_pc = self.pc
+        elif mnem == 'PHA':
+            self.push(self.a)
+        elif mnem == 'PHP':
+            self.push(self.p | FLAG_B | FLAG_U)
+        elif mnem == 'PLA':
+            self.a = self._nz(self.pull())
+        elif mnem == 'PLP':
+            self.p = (self.pull() & ~FLAG_B) | FLAG_U
+        elif mnem == 'TAX':
+            self.x = self._nz(self.a)
+        elif mnem == 'TAY':
+            self.y = self._nz(self.a)
+        elif mnem == 'TXA':
+            self.a = self._nz(self.x)
+        elif mnem == 'TYA':
+            self.a = self._nz(self.y)
+        elif mnem == 'TSX':
+            self.x = self._nz(self.s)
+        elif mnem == 'TXS':
+            self.s = self.x
+        elif mnem == 'INX':
+            self.x = self._nz((self.x + 1) & 0xFF)
+        elif mnem == 'INY':
+            self.y = self._nz((self.y + 1) & 0xFF)
+        elif mnem == 'DEX':
+            self.x = self._nz((self.x - 1) & 0xFF)
+        elif mnem == 'DEY':
+            self.y = self._nz((self.y - 1) & 0xFF)
+        elif mnem == 'CLC':
+            self.p &= ~FLAG_C
+        elif mnem == 'SEC':
+            self.p |= FLAG_C
+        elif mnem == 'CLI':
+            self.p &= ~FLAG_I
+        elif mnem == 'SEI':
+            self.p |= FLAG_I
+        elif mnem == 'CLV':
+            self.p &= ~FLAG_V
+        elif mnem == 'CLD':
+            self.p &= ~FLAG_D
+        elif mnem == 'SED':
+            self.p |= FLAG_D
+        elif mnem == '???':
+            self.illegal += 1
+
+        self.pc = next_pc
+        self.cycles += cycles
+        self.instructions += 1
+        for hook in self.hooks:
+            hook(self, pc, cycles)
+        return cycles
+
+    def run(self, max_cycles=None, until=None):
+        """
+        Ejecutar hasta que la CPU espere entrada que no llegará, hasta
+        max_cycles, o hasta que until(system) sea verdadero
+        """
+        while True:
+            self.step()
+            if self.uart.waiting():
+                return 'idle'
+            if max_cycles is not None and self.cycles >= max_cycles:
+                return 'limit'
+            if until is not None and until(self):
+                return 'until'
+
+
+# ============================================
+# PERFIL (HEATMAP + COBERTURA)
+# ============================================
+
+class Profiler:
+    """
+    Cuenta ejecuciones y ciclos por dirección de instrucción.
+    scope = 'session': todo; 'runs': todas las ejecuciones de programas;
+    un entero N: solo la N-ésima ejecución.
+
+    Salvo en 'session' solo cuenta el programa: desde el RTI con el que
+    mon_ctx_go entra en él hasta su BRK (paso, breakpoint o el suyo) o
+    hasta llegar a mon_ctx_exit (su RTS final). El manejador de BRK de la
+    ROM y el cambio de contexto quedan fuera; las rutinas de ROM que llame
+    el programa cuentan dentro. Una ejecución es un comando del monitor
+    (G, C, X, Y, Z, @...) que entra al menos una vez en el programa: los
+    pasos de Z n o las paradas en breakpoints con contador no cuentan
+    aparte. J llama a la rutina sin cambio de contexto: solo en 'session'.
+    """
+
+    CTX_SYMBOLS = ('_monitor_process_cmd', '_mon_ctx_go', '_mon_ctx_exit')
+
+    def __init__(self, scope='runs', symbols=None):
+        self.scope = scope
+        self.count = [0] * 0x10000
+        self.cycles = [0] * 0x10000
+        self.taken = {}         # (origen, destino) -> veces, saltos hacia atrás
+        self.runs = 0
+        self.active = scope == 'session'
+        self.entering = False   # Dentro de mon_ctx_go, antes de su RTI
+        self.counted = False    # El comando en curso ya contó como ejecución
+        self.total_cycles = 0
+        self.total_instr = 0
+        if scope != 'session':
+            symbols = symbols or {}
+            missing = [name for name in self.CTX_SYMBOLS if name not in symbols]
+            if missing:
+                raise ValueError(f"Faltan etiquetas para el perfil: {', '.join(missing)}")
+            self.cmd, self.go, self.exit = (symbols[name] for name in self.CTX_SYMBOLS)
+
+    def _context(self, pc, mnem):
+        """Seguir el cambio de contexto; retorna False si la instrucción no es del programa"""
+        if pc == self.cmd:
+            self.counted = False
+        elif pc == self.go:
+            self.entering = True
+        elif self.entering and mnem == 'RTI':
+            # Entrada en el programa
+            self.entering = False
+            if not self.counted:
+                self.counted = True
+                self.runs += 1
+            self.active = self.scope == 'runs' or self.scope == self.runs
+            return False
+        elif self.active and (mnem == 'BRK' or pc == self.exit):
+            # BRK o vuelta a mon_ctx_exit: el resto es del monitor
+            self.active = False
+        return self.active
+
+    def __call__(self, system, pc, cycles):
+        mnem, mode = OPCODES.get(system.peek(pc), ILLEGAL)[:2]
+        if self.scope != 'session' and not self._context(pc, mnem):
+            return
+        if self.active:
+            self.count[pc] += 1
+            self.cycles[pc] += cycles
+            self.total_cycles += cycles
+            self.total_instr += 1
+            if system.pc <= pc and (mode == 'rel' or mnem == 'JMP'):
+                key = (pc, system.pc)
+                self.taken[key] = self.taken.get(key, 0) + 1
+
+    def hot_loops(self, limit=10):
+        """Lazos = saltos hacia atrás tomados; ciclos = suma del rango destino..origen"""
+        loops = []
+        for (src, dst), times in self.taken.items():
+            total = sum(self.cycles[dst:src + 1])
+            loops.append((total, times, dst, src))
+        loops.sort(reverse=True)
+        return loops[:limit]
+
+    def hot_instructions(self, limit=20):
+        hot = [(self.cycles[a], self.count[a], a) for a in range(0x10000) if self.count[a]]
+        hot.sort(reverse=True)
+        return hot[:limit]
+
+    def regions(self, gap=16):
+        """Rangos contiguos de direcciones ejecutadas"""
+        regions = []
+        for addr in range(0x10000):
+            if not self.count[addr]:
+                continue
+            if regions and addr - regions[-1][1] <= gap:
+                regions[-1][1] = addr
+            else:
+                regions.append([addr, addr])
+        return regions
+
+
+def read_labels(path):
+    """(dirección, nombre) de ld65 -Ln (formato VICE: 'al 008123 ._nombre')"""
+    for line in Path(path).read_text().splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[0] == 'al':
+            yield int(parts[1], 16), parts[2].lstrip('.')
+
+
+def load_labels(path):
+    """Dirección -> primera etiqueta (sin las locales '@')"""
+    labels = {}
+    for addr, name in read_labels(path):
+        if not name.startswith('@') and addr not in labels:
+            labels[addr] = name
+    return labels
+
+
+def symbol_for(labels, addr):
+    """Etiqueta más cercana por debajo: 'nombre+off'"""
+    best = None
+    for base in labels:
+        if base <= addr and (best is None or base > best):
+            best = base
+    if best is None or addr - best > 0x400:
+        return ''
+    off = addr - best
+    return labels[best] + (f"+{off}" if off else '')
+
+
+def write_profile(path, system, prof, labels):
+    total = prof.total_cycles or 1
+    lines = [f"; Perfil 6502 - {prof.runs} ejecuciones, ámbito: {prof.scope}",
+             f"; {prof.total_cycles} ciclos, {prof.total_instr} instrucciones "
+             f"({prof.total_cycles / CPU_HZ * 1000:.3f} ms a {CPU_HZ / 1e6:.3f} MHz)", "",
+             "; === LAZOS MÁS CALIENTES ===",
+             ";   ciclos      %     iter  rango        símbolo"]
+    for cycles, times, dst, src in prof.hot_loops():
+        lines.append(f"  {cycles:9d} {100.0 * cycles / total:6.2f}% {times:7d}  ${dst:04X}-${src:04X}  "
+                     f"{symbol_for(labels, dst)}")
+    lines += ["", "; === INSTRUCCIONES MÁS CALIENTES ===",
+              ";   ciclos      %    veces  dir    instrucción          símbolo"]
+    for cycles, count, addr in prof.hot_instructions():
+        text, _ = disassemble(system.peek, addr)
+        lines.append(f"  {cycles:9d} {100.0 * cycles / total:6.2f}% {count:7d}  ${addr:04X}  {text:<20} "
+                     f"{symbol_for(labels, addr)}")
+    Path(path).write_text("\n".join(lines) + "\n")
+
+
+def write_listing(path, system, prof, labels):
+    """Listado anotado: veces, ciclos, barra de calor y cobertura por región"""
+    total = prof.total_cycles or 1
+    peak = max(prof.cycles) or 1
+    lines = []
+    for start, end in prof.regions():
+        executed = instrs = 0
+        lines.append(f"; ---- ${start:04X}-${end:04X} {symbol_for(labels, start)}")
+        addr = start
+        while addr <= end:
+            if addr in labels:
+                lines.append(f"{labels[addr]}:")
+            text, length = disassemble(system.peek, addr)
+            # Resincronizar si la instrucción pisa una dirección ejecutada
+            if any(prof.count[addr + i] for i in range(1, length) if addr + i <= 0xFFFF):
+                text, length = f".byte ${system.peek(addr):02X}", 1
+            instrs += 1
+            count, cycles = prof.count[addr], prof.cycles[addr]
+            if count:
+                executed += 1
+                heat = '#' * max(1, (cycles * 10) // peak)
+                lines.append(f"  {count:8d} {cycles:10d} {100.0 * cycles / total:6.2f}% {heat:<10} "
+                             f"${addr:04X}  {text}")
+            else:
+                lines.append(f"  {'-':>8} {'':>10} {'':>7} {'':<10} ${addr:04X}  {text}")
+            addr += length
+        lines.append(f"; Cobertura: {executed}/{instrs} instrucciones ({100.0 * executed / instrs:.1f}%)")
+        lines.append("")
+    Path(path).write_text("\n".join(lines))
+
+
+# ============================================
+# LÍNEA DE COMANDOS
+# ============================================
+
+def parse_int(value):
+    return int(value, 0)
+
+
+def parse_load(spec):
+    """archivo.bin@dir"""
+    path, _, addr = spec.rpartition('@')
+    if not path:
+        raise argparse.ArgumentTypeError(f"Carga inválida '{spec}'. Formato archivo.bin@0x0200")
+    return (path, int(addr, 0))
+
+
+def build_parser():
+    parser = argparse.ArgumentParser(
+        description='Emulador 6502 + UART para ejecutar la ROM del monitor',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('rom', nargs='?', default='output/rom.bin', help='Imagen ROM de 8 KB o build/main.bin')
+    parser.add_argument('-i', '--input', help='Archivo con comandos del monitor (una línea por comando)')
+    parser.add_argument('-c', '--cmd', action='append', default=[], help='Comando del monitor (repetible)')
+    parser.add_argument('--load', action='append', default=[], type=parse_load, metavar='BIN@DIR',
+                        help='Cargar un binario en RAM antes del reset')
+    parser.add_argument('--baud', type=int, default=115200, help='Velocidad de la UART (0 = instantánea)')
+    parser.add_argument('--max-cycles', type=int, default=200_000_000, help='Límite de ciclos')
+    parser.add_argument('--quiet', action='store_true', help='No mostrar la salida de la UART')
+    parser.add_argument('--labels', help='Etiquetas de ld65 (-Ln build/main.lbl)')
+    parser.add_argument('--profile', help='Escribir perfil (lazos e instrucciones más calientes)')
+    parser.add_argument('--listing', help='Escribir listado anotado con heatmap y cobertura')
+    parser.add_argument('--profile-run', default='runs',
+                        help="Ámbito del perfil: 'runs' (todas las ejecuciones), 'session' o N (la N-ésima); "
+                             "salvo 'session' necesita --labels")
+    return parser
+
+
+def script_lines(args):
+    lines = []
+    if args.input:
+        lines += Path(args.input).read_text().splitlines()
+    lines += args.cmd
+    return [line.encode('ascii') + b'\r' for line in lines]
+
+
+def main():
+    parser = build_parser()
+    args = parser.parse_args()
+    out = None if args.quiet else sys.stdout.buffer
+    uart = Uart(baud=args.baud, out=out)
+    for line in script_lines(args):
+        uart.feed(line)
+
+    system = System(load_rom(args.rom), uart)
+    for path, addr in args.load:
+        system.load(addr, Path(path).read_bytes())
+
+    prof = None
+    if args.profile or args.listing:
+        scope = args.profile_run if args.profile_run in ('runs', 'session') else int(args.profile_run, 0)
+        if scope != 'session' and not args.labels:
+            parser.error("--profile-run runs o N necesita --labels (mon_ctx_go y mon_ctx_exit)")
+        symbols = {name: addr for addr, name in read_labels(args.labels)} if args.labels else {}
+        try:
+            prof = Profiler(scope, symbols)
+        except ValueError as e:
+            parser.error(str(e))
+        system.hooks.append(prof)
+
+    system.reset()
+    reason = system.run(max_cycles=args.max_cycles)
+
+    print(f"\n[emu] fin: {reason}, {system.cycles} ciclos, {system.instructions} instrucciones"
+          f"{f', {system.illegal} opcodes ilegales' if system.illegal else ''}", file=sys.stderr)
+
+    if prof is not None:
+        labels = load_labels(args.labels) if args.labels else {}
+        if args.profile:
+            write_profile(args.profile, system, prof, labels)
+            print(f"[emu] perfil: {args.profile}", file=sys.stderr)
+        if args.listing:
+            write_listing(args.listing, system, prof, labels)
+            print(f"[emu] listado: {args.listing}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,259 @@
+#!/usr/bin/env python3
+"""
+Barridos de sesiones del monitor en paralelo sobre el emulador
+
+Cada sesión es una instancia independiente de emu6502.py con su propio
+guion de UART y su instantánea de RAM. Las sesiones salen de:
+  --scripts DIR   archivos *.txt (un comando por línea); si existe
+                  nombre.ram se carga en $0000 antes del reset
+  --sweep D,M,... cada comando sobre una rejilla de direcciones y
+                  longitudes (L: tamaños de carga; DM: D y M seguidos en
+                  la misma sesión, comprobando la salida de M)
+  --random N      N sesiones de comandos aleatorios
+Se reparten entre todos los núcleos y el informe (ciclos, fin, errores y
+huella de la salida por sesión, más un resumen por grupo) sale siempre en
+el mismo orden: la misma semilla da el mismo informe.
+"""
+
+import argparse
+import hashlib
+import os
+import random
+import re
+import sys
+from multiprocessing import Pool
+from pathlib import Path
+
+from emu6502 import RAM_SIZE, System, Uart, load_rom
+
+USER_START = 0x0200
+USER_END = 0x39FF
+
+# Rejilla de los barridos
+SWEEP_ADDRS = (0x0200, 0x02F8, 0x1000, 0x38F0, 0x8000)
+SWEEP_LENS = (0x01, 0x0F, 0x10, 0x11, 0x100, 0x400)
+SWEEP_LOADS = (1, 16, 64, 256, 1024)
+CHAIN_LINES = 8         # Instrucciones de la M en las sesiones DM
+
+# Configuración de cada proceso del pool (ver init_worker)
+_rom = None
+_baud = 0
+_max_cycles = 0
+
+
+# ============================================
+# GENERACIÓN DE SESIONES
+# ============================================
+
+def job_rng(seed, name):
+    """Generador propio de cada sesión: no depende del orden de ejecución"""
+    return random.Random(f"{seed}:{name}")
+
+
+def hex_lines(data, per_line=16):
+    return [' '.join(f"{b:02X}" for b in data[i:i + per_line]) for i in range(0, len(data), per_line)]
+
+
+def user_range(rng, max_len=0x400):
+    addr = rng.randint(USER_START, USER_END)
+    return addr, rng.randint(1, min(max_len, USER_END - addr + 1))
+
+
+def random_command(rng):
+    """Un comando que no ejecuta código del usuario"""
+    kind = rng.choice('RWDDMFSTVIAB#E')
+    addr, length = user_range(rng)
+    if kind == 'R':
+        return f"R {rng.randint(0, 0xFFFF):04X}"
+    if kind == 'W':
+        return f"W {addr:04X} {rng.randint(0, 0xFF):02X}"
+    if kind == 'D':
+        return f"D {rng.choice((addr, rng.randint(0x8000, 0x9FFF))):04X} {length:X} {rng.choice(('', 'Z', 'T'))}"
+    if kind == 'M':
+        return f"M {rng.choice((addr, rng.randint(0x8000, 0x9FFF))):04X} {rng.randint(1, 0x20):X}"
+    if kind == 'F':
+        return f"F {addr:04X} {length:X} {rng.choice((0x00, 0xEA, 0xFF, rng.randint(0, 0xFF))):02X}"
+    if kind == 'S':
+        return f"S {addr:04X} {length:X}"
+    if kind == 'T':
+        return f"T {addr:04X} {min(length, 0x100):X}"
+    if kind == 'A':
+        return rng.choice(("A", f"A {addr:04X} {length:X} R{rng.randint(0, 99)}", f"A {addr:04X} 0"))
+    if kind == 'B':
+        return rng.choice(("B", f"B {addr:04X}", "K"))
+    if kind == 'E':
+        return f"E {rng.randint(2, 0x80):X}"
+    return kind
+
+
+def script_jobs(directory):
+    jobs = []
+    for path in sorted(Path(directory).glob('*.txt')):
+        ram = path.with_suffix('.ram')
+        jobs.append((f"script-{path.stem}", 'script', path.read_text().splitlines(),
+                     ram.read_bytes()[:RAM_SIZE] if ram.exists() else None))
+    return jobs
+
+
+def sweep_jobs(commands, seed):
+    jobs = []
+    for cmd in commands:
+        if cmd == 'DM':
+            for addr in SWEEP_ADDRS:
+                jobs.append((f"DM-{addr:04X}", 'DM', [f"D {addr:04X} 40", f"M {addr:04X} {CHAIN_LINES:X}"], None))
+            continue
+        if cmd == 'L':
+            for size in SWEEP_LOADS:
+                name = f"L-{size}"
+                data = bytes(job_rng(seed, name).randrange(256) for _ in range(size))
+                jobs.append((name, 'L', [f"L {USER_START:04X}"] + hex_lines(data) + ['.'], None))
+            continue
+        for addr in SWEEP_ADDRS:
+            for length in SWEEP_LENS:
+                if cmd in 'FT' and (addr < USER_START or addr + length - 1 > USER_END):
+                    continue
+                line = {'D': f"D {addr:04X} {length:X}",
+                        'M': f"M {addr:04X} {min(length, 0xFF):X}",
+                        'F': f"F {addr:04X} {length:X} A5",
+                        'S': f"S {addr:04X} {length:X}",
+                        'T': f"T {addr:04X} {length:X}"}.get(cmd)
+                if line is None:
+                    raise ValueError(f"Barrido no soportado: '{cmd}' (D, M, F, S, T, L, DM)")
+                jobs.append((f"{cmd}-{addr:04X}-{length:X}", cmd, [line], None))
+    return jobs
+
+
+def random_jobs(count, steps, seed):
+    jobs = []
+    for i in range(count):
+        name = f"random-{i:05d}"
+        rng = job_rng(seed, name)
+        ram = bytearray(RAM_SIZE)
+        ram[USER_START:USER_END + 1] = bytes(rng.randrange(256) for _ in range(USER_END - USER_START + 1))
+        jobs.append((name, 'random', [random_command(rng) for _ in range(steps)], bytes(ram)))
+    return jobs
+
+
+# ============================================
+# EJECUCIÓN
+# ============================================
+
+def chain_bad(output, lines):
+    """
+    Sesión DM: la M llega entera tras la D y lista sus CHAIN_LINES
+    instrucciones desde su dirección. Retorna 1 si no
+    """
+    m = re.search(rb'>' + re.escape(lines[1].encode('ascii')) +
+                  rb'\r\n((?:[0-9A-F]{4}  [^\r\n]*\r\n)*)\r\n>', output)
+    if not m or m.group(1).count(b'\r\n') != CHAIN_LINES:
+        return 1
+    return 0 if m.group(1).startswith(lines[1][2:6].encode('ascii')) else 1
+
+
+def init_worker(rom, baud, max_cycles):
+    global _rom, _baud, _max_cycles
+    _rom, _baud, _max_cycles = rom, baud, max_cycles
+
+
+def run_job(job):
+    """
+    Una sesión: reset, banner, guion. Los ciclos van del primer prompt al
+    último byte enviado (sin la espera final de entrada)
+    """
+    name, group, lines, ram = job
+    uart = Uart(baud=_baud)
+    uart.tx_times = []
+    system = System(_rom, uart)
+    if ram:
+        system.load(0, ram)
+    system.reset()
+    system.run(max_cycles=_max_cycles)
+
+    start, mark = system.cycles, len(uart.tx_log)
+    for line in lines:
+        uart.feed(line.encode('ascii') + b'\r')
+    reason = system.run(max_cycles=start + _max_cycles)
+
+    output = bytes(uart.tx_log[mark:])
+    end = uart.tx_times[-1] if output else start
+    return {'name': name, 'group': group, 'reason': reason,
+            'cycles': (system.cycles if reason != 'idle' else end) - start,
+            'errors': output.count(b'ERR:'),
+            'bad': chain_bad(output, lines) if group == 'DM' else 0,
+            'illegal': system.illegal,
+            'output': output}
+
+
+# ============================================
+# INFORME
+# ============================================
+
+def write_report(out, results, args, rom_hash):
+    out.write(f"; Barrido de {len(results)} sesiones, semilla {args.seed}, ROM {args.rom} ({rom_hash})\n")
+    out.write(f"; {args.baud} baud, límite {args.max_cycles} ciclos por sesión\n\n")
+    out.write(";    ciclos  fin    err  bytes  huella    sesión\n")
+    for r in results:
+        flag = '' if r['reason'] == 'idle' and not r['illegal'] and not r['bad'] else '  <--'
+        out.write(f"  {r['cycles']:9d}  {r['reason']:<5} {r['errors']:4d} "
+                  f"{len(r['output']):6d}  {hashlib.sha1(r['output']).hexdigest()[:8]}  {r['name']}{flag}\n")
+
+    out.write("\n; === POR GRUPO ===\n")
+    out.write("; grupo     sesiones   ciclos mín      media       máx  err  mal  sin terminar\n")
+    groups = {}
+    for r in results:
+        groups.setdefault(r['group'], []).append(r)
+    for group, rs in groups.items():
+        cycles = [r['cycles'] for r in rs]
+        out.write(f"  {group:<8} {len(rs):9d} {min(cycles):12d} {sum(cycles) // len(rs):10d} {max(cycles):9d}"
+                  f" {sum(r['errors'] for r in rs):4d} {sum(r['bad'] for r in rs):4d}"
+                  f" {sum(r['reason'] != 'idle' for r in rs):13d}\n")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='Ejecuta muchas sesiones del monitor en paralelo sobre el emulador',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('rom', nargs='?', default='build/main.bin', help='build/main.bin u output/rom.bin')
+    parser.add_argument('--scripts', help='Directorio de guiones *.txt (y *.ram opcionales)')
+    parser.add_argument('--sweep', default='', help='Comandos a barrer, separados por comas (D,M,F,S,T,L,DM)')
+    parser.add_argument('--random', type=int, default=0, help='Número de sesiones aleatorias')
+    parser.add_argument('--steps', type=int, default=20, help='Comandos por sesión aleatoria')
+    parser.add_argument('--seed', default='1', help='Semilla de los datos y sesiones aleatorias')
+    parser.add_argument('-j', '--jobs', type=int, default=os.cpu_count(), help='Procesos en paralelo')
+    parser.add_argument('--baud', type=int, default=115200, help='Velocidad de la UART (0 = instantánea)')
+    parser.add_argument('--max-cycles', type=int, default=50_000_000, help='Límite por sesión')
+    parser.add_argument('-o', '--output', help='Archivo del informe (por defecto, la salida estándar)')
+    parser.add_argument('--outputs', help='Directorio donde guardar la salida UART de cada sesión')
+    args = parser.parse_args()
+
+    try:
+        rom = load_rom(args.rom)
+        jobs = []
+        if args.scripts:
+            jobs += script_jobs(args.scripts)
+        if args.sweep:
+            jobs += sweep_jobs([c.strip().upper() for c in args.sweep.split(',') if c.strip()], args.seed)
+        jobs += random_jobs(args.random, args.steps, args.seed)
+        if not jobs:
+            raise ValueError("Sin sesiones: usar --scripts, --sweep o --random")
+
+        with Pool(max(1, args.jobs), initializer=init_worker,
+                  initargs=(rom, args.baud, args.max_cycles)) as pool:
+            results = pool.map(run_job, jobs, chunksize=max(1, len(jobs) // (8 * max(1, args.jobs))))
+
+        if args.outputs:
+            out_dir = Path(args.outputs)
+            out_dir.mkdir(parents=True, exist_ok=True)
+            for r in results:
+                (out_dir / f"{r['name']}.txt").write_bytes(r['output'])
+
+        rom_hash = hashlib.sha1(rom).hexdigest()[:8]
+        if args.output:
+            with open(args.output, 'w', encoding='utf-8') as f:
+                write_report(f, results, args, rom_hash)
+            print(f"Informe: {args.output} ({len(results)} sesiones)")
+        else:
+            write_report(sys.stdout, results, args, rom_hash)
+    except Exception as e:
+        print(f"❌ Error: {e}")
+        exit(1)
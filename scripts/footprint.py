@@ -0,0 +1,339 @@
+#!/usr/bin/env python3
+"""
+Informe de huella de ROM/RAM y de ciclos por llamada
+
+A partir de lo que deja el enlazado (make):
+  - config/fpga.cfg     áreas MEMORY y en cuál se carga cada segmento
+  - build/main.map      tamaño de cada segmento y de cada módulo (-m)
+  - build/main.dbg      funciones con su tamaño (--dbgfile, cc65 -g)
+  - build/main.lbl      etiquetas (-Ln), para lo que no tenga ámbito
+informa de los bytes por área (con el margen libre), por segmento, por
+módulo y por función. Con --hot ejecuta una sesión en emu6502.py y mide
+los ciclos por llamada de esas rutinas (de su primera instrucción a su
+RTS, esperas de la UART incluidas) desde el reset hasta el final de la
+sesión.
+
+Termina con código 1 si la ROM ocupada supera --rom-max.
+"""
+
+import argparse
+import re
+import sys
+from pathlib import Path
+
+from emu6502 import CPU_HZ, OPCODES, System, Uart, load_rom
+
+# Sesión por defecto para --hot: comandos que pasan por las rutinas medidas
+HOT_SESSION = ["D 8000 100", "M 8000 20", "F 0200 100 EA", "S 0200 100",
+               "T 0200 40", "R 8000", "W 0200 60", "L 0300",
+               "A9 00 A2 10 CA D0 FD 60", "."]
+
+SEGMENT_ORDER = ('STARTUP', 'CODE', 'RODATA', 'ONCE', 'DATA', 'ZEROPAGE', 'VECRAM', 'BSS', 'NOINIT')
+REPORT_SEGMENTS = ('CODE', 'RODATA', 'DATA', 'BSS', 'ZEROPAGE')
+CODE_AREA = 'ROM'
+
+KV_RE = re.compile(r'(\w+)\s*=\s*("[^"]*"|[^,;]+)')
+
+
+def parse_int(value):
+    try:
+        return int(value, 0)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"Valor inválido: '{value}'")
+
+
+def parse_limit(value):
+    """Bytes (0x1F00) o porcentaje del área ROM (95%)"""
+    if value.endswith('%'):
+        try:
+            return ('%', float(value[:-1]))
+        except ValueError:
+            raise argparse.ArgumentTypeError(f"Porcentaje inválido: '{value}'")
+    return ('bytes', parse_int(value))
+
+
+def cfg_int(text):
+    text = text.strip()
+    return int(text[1:], 16) if text.startswith('$') else int(text, 0)
+
+
+# ============================================
+# LECTURA DE CONFIG, MAPA Y DEPURACIÓN
+# ============================================
+
+def read_config(path):
+    """Retorna ({área: (inicio, tamaño)}, {segmento: área})"""
+    text = re.sub(r'#.*', '', Path(path).read_text(encoding='utf-8'))
+    blocks = dict(re.findall(r'(\w+)\s*\{([^}]*)\}', text))
+    areas, loads = {}, {}
+    for name, body in re.findall(r'(\w+)\s*:([^;]*);', blocks.get('MEMORY', '')):
+        fields = dict(KV_RE.findall(body))
+        areas[name] = (cfg_int(fields['start']), cfg_int(fields['size']))
+    for name, body in re.findall(r'(\w+)\s*:([^;]*);', blocks.get('SEGMENTS', '')):
+        loads[name] = dict(KV_RE.findall(body))['load'].strip()
+    if CODE_AREA not in areas:
+        raise ValueError(f"{path}: falta el área {CODE_AREA} en MEMORY")
+    return areas, loads
+
+
+def map_sections(path):
+    """Secciones 'Título:' / '-----' del mapa de ld65 -> {título: [líneas]}"""
+    lines = Path(path).read_text(encoding='utf-8', errors='replace').splitlines()
+    sections, title = {}, None
+    for i, line in enumerate(lines):
+        if i + 1 < len(lines) and line.endswith(':') and lines[i + 1].startswith('---'):
+            title = line[:-1]
+            sections[title] = []
+        elif title is not None and not line.startswith('---'):
+            sections[title].append(line)
+    return sections
+
+
+def read_map(path):
+    """Retorna ({segmento: (inicio, tamaño)}, {módulo: {segmento: tamaño}})"""
+    sections = map_sections(path)
+    segments = {}
+    for line in sections.get('Segment list', []):
+        parts = line.split()
+        if len(parts) == 5 and parts[0] != 'Name':
+            segments[parts[0]] = (int(parts[1], 16), int(parts[3], 16))
+    if not segments:
+        raise ValueError(f"{path}: sin 'Segment list' (¿enlazado con -m?)")
+
+    modules, module = {}, None
+    for line in sections.get('Modules list', []):
+        if not line.strip():
+            continue
+        if not line.startswith(' '):
+            # 'monitor.o:' o 'D:\cc65\lib\none.lib(zerobss.o):'
+            module = re.sub(r'^.*[\\/]', '', line.rstrip(':'))
+            modules.setdefault(module, {})
+            continue
+        m = re.match(r'\s+(\w+)\s+Offs=\w+\s+Size=(\w+)', line)
+        if m and module is not None:
+            seg = modules[module]
+            seg[m.group(1)] = seg.get(m.group(1), 0) + int(m.group(2), 16)
+    return segments, modules
+
+
+def read_dbg(path):
+    """Funciones con ámbito (.proc de cc65 -g): [(dirección, tamaño, nombre, módulo)]"""
+    mods, syms, scopes = {}, {}, []
+    for line in Path(path).read_text(encoding='utf-8', errors='replace').splitlines():
+        kind, _, rest = line.partition('\t')
+        fields = {k: v.strip('"') for k, v in KV_RE.findall(rest)}
+        if kind == 'mod':
+            mods[fields['id']] = fields['name']
+        elif kind == 'sym' and fields.get('type') == 'lab' and 'val' in fields:
+            syms[fields['id']] = int(fields['val'], 0)
+        elif kind == 'scope' and fields.get('type') == 'scope' and 'sym' in fields:
+            scopes.append(fields)
+    funcs = []
+    for s in scopes:
+        addr = syms.get(s['sym'])
+        if addr is not None and int(s.get('size', 0)):
+            funcs.append((addr, int(s['size']), s['name'], mods.get(s.get('mod'), '')))
+    return sorted(funcs)
+
+
+def read_labels(path):
+    """Etiquetas de ld65 -Ln: {dirección: nombre}"""
+    labels = {}
+    for line in Path(path).read_text().splitlines():
+        parts = line.split()
+        if len(parts) == 3 and parts[0] == 'al':
+            name = parts[2].lstrip('.')
+            if not name.startswith('@'):
+                labels.setdefault(int(parts[1], 16), name)
+    return labels
+
+
+def functions(segments, funcs, labels):
+    """
+    Bloques del código: las funciones con ámbito y, en los huecos que
+    dejan (ensamblador sin .proc, runtime), una entrada por etiqueta
+    """
+    start, size = segments.get('CODE', (0, 0))
+    end = start + size
+    starts = sorted(set(a for a in [a for a, *_ in funcs] + [a + sz for a, sz, *_ in funcs] + list(labels)
+                        if start <= a < end))
+    if start not in starts:
+        starts.insert(0, start)
+    known = {a: (sz, name, mod) for a, sz, name, mod in funcs}
+    covered = set()
+    for a, sz, *_ in funcs:
+        covered.update(range(a, a + sz))
+
+    blocks = []
+    for i, addr in enumerate(starts):
+        nxt = starts[i + 1] if i + 1 < len(starts) else end
+        if addr in known:
+            sz, name, mod = known[addr]
+            blocks.append((addr, sz, name, mod))
+        elif addr not in covered:
+            stop = next((a for a in range(addr, nxt) if a in covered), nxt)
+            if stop > addr:
+                blocks.append((addr, stop - addr, labels.get(addr, f"${addr:04X}"), ''))
+    return blocks
+
+
+# ============================================
+# CICLOS POR LLAMADA (EMULADOR)
+# ============================================
+
+class CallTimer:
+    """
+    Ciclos por llamada de unas rutinas: empieza al ejecutar su primera
+    instrucción y acaba con el RTS que sube la pila por encima de la
+    que tenía al entrar (vale también para llamadas por JMP)
+    """
+
+    def __init__(self, entries):
+        self.entries = entries          # {dirección: nombre}
+        self.active = []                # (nombre, S de entrada, ciclo de inicio)
+        self.calls = {name: [] for name in entries.values()}
+
+    def __call__(self, system, pc, cycles):
+        if pc in self.entries and (not self.active or self.active[-1][:2] != (self.entries[pc], system.prev_s)):
+            # (Un salto de vuelta a la primera instrucción no es otra llamada)
+            self.active.append((self.entries[pc], system.prev_s, system.cycles - cycles))
+        if self.active and OPCODES.get(system.peek(pc), ('',))[0] == 'RTS':
+            while self.active and system.s > self.active[-1][1]:
+                name, _, start = self.active.pop()
+                self.calls[name].append(system.cycles - start)
+
+
+def time_calls(rom, entries, session, baud, max_cycles):
+    uart = Uart(baud=baud)
+    system = System(rom, uart)
+    timer = CallTimer(entries)
+    system.hooks.append(timer)
+    for line in session:
+        uart.feed(line.encode('ascii') + b'\r')
+    system.reset()
+    if system.run(max_cycles=max_cycles) != 'idle':
+        raise RuntimeError("La sesión de --hot no terminó (¿--max-cycles?)")
+    return timer.calls
+
+
+def resolve(name, blocks, labels):
+    for cand in (name, '_' + name):
+        for addr, _, block, _ in blocks:
+            if block == cand:
+                return addr
+        for addr, label in labels.items():
+            if label == cand:
+                return addr
+    raise ValueError(f"Rutina desconocida: '{name}' (¿falta build/main.dbg?)")
+
+
+# ============================================
+# INFORME
+# ============================================
+
+def write_report(out, areas, loads, segments, modules, blocks, calls, top):
+    used = {}
+    for seg, (_, size) in segments.items():
+        area = loads.get(seg)
+        used[area] = used.get(area, 0) + size
+
+    out.write("; === ÁREAS DE MEMORIA ===\n")
+    out.write("; área       inicio  tamaño   usado   libre      %\n")
+    for area, (start, size) in areas.items():
+        if area in used:
+            out.write(f"  {area:<10} ${start:04X} {size:7d} {used[area]:7d} {size - used[area]:7d} "
+                      f"{100.0 * used[area] / size:5.1f}%\n")
+
+    out.write("\n; === SEGMENTOS ===\n")
+    out.write("; segmento   inicio  tamaño  área\n")
+    order = [s for s in SEGMENT_ORDER if s in segments] + sorted(set(segments) - set(SEGMENT_ORDER))
+    for seg in order:
+        start, size = segments[seg]
+        out.write(f"  {seg:<10} ${start:04X} {size:7d}  {loads.get(seg, '?')}\n")
+
+    out.write("\n; === MÓDULOS ===\n")
+    out.write("; módulo              " + ''.join(f"{s:>9}" for s in REPORT_SEGMENTS) + "    otros\n")
+    for mod in sorted(modules, key=lambda m: -sum(modules[m].values())):
+        sizes = modules[mod]
+        if not sum(sizes.values()):
+            continue
+        other = sum(v for s, v in sizes.items() if s not in REPORT_SEGMENTS)
+        out.write(f"  {mod:<19} " + ''.join(f"{sizes.get(s, 0):9d}" for s in REPORT_SEGMENTS)
+                  + f" {other:8d}\n")
+
+    total = sum(b[1] for b in blocks) or 1
+    ranked = sorted(blocks, key=lambda b: -b[1])
+    out.write(f"\n; === FUNCIONES (CODE, {len(blocks)} bloques"
+              f"{f', las {top} mayores' if 0 < top < len(blocks) else ''}) ===\n")
+    out.write(";  bytes      %  dir    módulo          función\n")
+    for addr, size, name, mod in ranked[:top] if top > 0 else ranked:
+        out.write(f"  {size:5d} {100.0 * size / total:5.1f}%  ${addr:04X}  {mod:<15} {name}\n")
+
+    if calls:
+        out.write(f"\n; === CICLOS POR LLAMADA (emulador, {CPU_HZ / 1e6:.3f} MHz) ===\n")
+        out.write("; llamadas    mín     media      máx       total  función\n")
+        for name, times in calls.items():
+            if times:
+                out.write(f"  {len(times):8d} {min(times):6d} {sum(times) / len(times):9.1f} {max(times):8d}"
+                          f" {sum(times):11d}  {name}\n")
+            else:
+                out.write(f"  {0:8d} {'-':>6} {'-':>9} {'-':>8} {'-':>11}  {name}\n")
+    return used.get(CODE_AREA, 0)
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='Informe de huella ROM/RAM por segmento, módulo y función, y ciclos por llamada',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('--map', default='build/main.map', help='Mapa de ld65 (-m)')
+    parser.add_argument('--dbg', default='build/main.dbg', help='Depuración de ld65 (--dbgfile); opcional')
+    parser.add_argument('--labels', default='build/main.lbl', help='Etiquetas de ld65 (-Ln); opcional')
+    parser.add_argument('--config', default='config/fpga.cfg', help='Configuración del enlazador')
+    parser.add_argument('--rom', default='build/main.bin', help='Binario para --hot')
+    parser.add_argument('--hot', default='',
+                        help='Rutinas a medir en el emulador, separadas por comas (vacío = no medir)')
+    parser.add_argument('-i', '--input', help='Sesión para --hot (un comando por línea); por defecto, una '
+                                              'con D, M, F, S, T, R, W y L')
+    parser.add_argument('--baud', type=int, default=115200, help='Velocidad de la UART emulada')
+    parser.add_argument('--max-cycles', type=int, default=200_000_000, help='Límite de la sesión de --hot')
+    parser.add_argument('--top', type=int, default=40, help='Funciones a listar (0 = todas)')
+    parser.add_argument('--rom-max', type=parse_limit, default=parse_limit('95%'),
+                        help='Máximo de ROM ocupada: bytes o porcentaje del área ROM')
+    parser.add_argument('-o', '--output', help='Archivo del informe (por defecto, la salida estándar)')
+    args = parser.parse_args()
+
+    try:
+        areas, loads = read_config(args.config)
+        segments, modules = read_map(args.map)
+        funcs = read_dbg(args.dbg) if Path(args.dbg).exists() else []
+        labels = read_labels(args.labels) if Path(args.labels).exists() else {}
+        blocks = functions(segments, funcs, labels)
+
+        calls = {}
+        hot = [h.strip() for h in args.hot.split(',') if h.strip()]
+        if hot:
+            entries = {resolve(h, blocks, labels): h for h in hot}
+            session = Path(args.input).read_text().splitlines() if args.input else HOT_SESSION
+            calls = time_calls(load_rom(args.rom), entries, session, args.baud, args.max_cycles)
+            calls = {h: calls[h] for h in hot}
+
+        if args.output:
+            with open(args.output, 'w', encoding='utf-8') as f:
+                rom_used = write_report(f, areas, loads, segments, modules, blocks, calls, args.top)
+            print(f"Informe: {args.output}")
+        else:
+            rom_used = write_report(sys.stdout, areas, loads, segments, modules, blocks, calls, args.top)
+
+        rom_size = areas[CODE_AREA][1]
+        kind, value = args.rom_max
+        limit = int(rom_size * value / 100) if kind == '%' else value
+        verdict = (f"ROM: {rom_used} de {rom_size} bytes ({100.0 * rom_used / rom_size:.1f}%), "
+                   f"límite {limit}, libres {rom_size - rom_used}")
+    except Exception as e:
+        print(f"❌ Error: {e}")
+        exit(1)
+
+    if rom_used > limit:
+        print(f"❌ {verdict}: se supera el límite en {rom_used - limit} bytes")
+        sys.exit(1)
+    print(verdict)
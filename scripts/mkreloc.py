@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+Generador de programas reubicables para el comando U del monitor
+
+Compara dos enlaces del mismo programa, uno en BASE y otro en BASE+$100:
+los bytes que difieren en +1 son bytes altos de direcciones internas y
+forman la tabla de reubicación. El monitor elige una página libre (o la
+indicada) y suma la diferencia de página a esos bytes mientras carga.
+"""
+
+import argparse
+import struct
+from pathlib import Path
+
+RELOC_MAGIC = b'RL'
+NAME_LEN = 8
+
+
+def build_reloc(image_a, image_b, name, link_page, extra=0, entry=0):
+    """Construir la imagen reubicable a partir de los dos enlaces"""
+    if len(image_a) != len(image_b):
+        raise ValueError(f"Los enlaces no miden lo mismo ({len(image_a)} != {len(image_b)})")
+
+    relocs = []
+    for offset, (a, b) in enumerate(zip(image_a, image_b)):
+        if a == b:
+            continue
+        if (b - a) & 0xFF != 1:
+            raise ValueError(f"Diferencia no reubicable en +${offset:04X} (${a:02X} -> ${b:02X}); "
+                             "solo se admiten bytes altos")
+        relocs.append(offset)
+
+    header = RELOC_MAGIC + name.upper().encode('ascii')[:NAME_LEN].ljust(NAME_LEN, b'\0')
+    header += struct.pack('<BHHHH', link_page, len(image_a), extra, len(relocs), entry)
+    table = b''.join(struct.pack('<H', offset) for offset in relocs)
+    return header, bytes(image_a), table
+
+
+def to_hex_text(header, code, table, per_line=16):
+    """Texto para pegar tras 'U': cabecera en su propia línea y '.' final"""
+    lines = [' '.join(f"{b:02X}" for b in header)]
+    body = code + table
+    for i in range(0, len(body), per_line):
+        lines.append(' '.join(f"{b:02X}" for b in body[i:i + per_line]))
+    return '\n'.join(lines) + '\n.\n'
+
+
+def parse_int(value):
+    try:
+        return int(value, 0)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"Valor inválido: '{value}'")
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='Genera un programa reubicable (comando U) a partir de dos enlaces',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('bin_a', help='Programa enlazado en BASE')
+    parser.add_argument('bin_b', help='El mismo programa enlazado en BASE+$100')
+    parser.add_argument('-n', '--name', required=True, help=f'Nombre (hasta {NAME_LEN} caracteres)')
+    parser.add_argument('--base', type=parse_int, required=True, help='Dirección de enlace de bin_a ($xx00)')
+    parser.add_argument('--bss', type=parse_int, default=0, help='Bytes extra a reservar y poner a cero')
+    parser.add_argument('--entry', type=parse_int, default=0, help='Offset del punto de entrada')
+    parser.add_argument('-o', '--output', required=True, help='Archivo de salida (.txt = hex para pegar)')
+    args = parser.parse_args()
+
+    try:
+        if args.base & 0xFF:
+            raise ValueError("BASE debe empezar en frontera de página ($xx00)")
+        header, code, table = build_reloc(Path(args.bin_a).read_bytes(), Path(args.bin_b).read_bytes(),
+                                          args.name, args.base >> 8, args.bss, args.entry)
+        out = Path(args.output)
+        if out.suffix.lower() == '.txt':
+            out.write_text(to_hex_text(header, code, table))
+        else:
+            out.write_bytes(header + code + table)
+        print(f"Generado: {out} ({len(code)} bytes, {len(table) // 2} reubicaciones, "
+              f"{len(code) + args.bss} bytes en RAM)")
+    except Exception as e:
+        print(f"❌ Error: {e}")
+        exit(1)
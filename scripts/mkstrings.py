@@ -0,0 +1,209 @@
+#!/usr/bin/env python3
+"""
+Compresor de la tabla de mensajes del monitor
+
+Lee libs/monitor/mon_strings.txt y genera:
+  - <salida>.s: tabla comprimida (segmento RODATA) para ca65
+  - <salida>.h: índices MSG_xxx y MSG_DEPTH para monitor.c
+
+Compresión por pares de bytes (BPE): los bytes $80-$FF son tokens que
+sustituyen a un par de símbolos (literales u otros tokens). El decodificador
+(mon_msg en monitor.c) expande con una pila de MSG_DEPTH bytes.
+
+Formato del archivo de entrada:
+  ## comentario
+  @NOMBRE          empieza un mensaje
+  texto            cada línea termina en CR LF...
+  texto\\          ...salvo si acaba en '\\'
+  @@texto          línea que empieza por '@'
+Las líneas en blanco al final de un mensaje se ignoran.
+"""
+
+import argparse
+from collections import Counter
+from pathlib import Path
+
+MAX_TOKENS = 128
+MAX_DEPTH = 14          # Pila del decodificador = MAX_DEPTH + 1 (redondeada)
+
+
+def parse_messages(text):
+    """Lista de (nombre, bytes) en orden de aparición"""
+    messages = []
+    name, lines = None, []
+
+    def flush():
+        if name is None:
+            return
+        while lines and lines[-1] == '':
+            lines.pop()
+        out = ''
+        for line in lines:
+            if line.endswith('\\'):
+                out += line[:-1]
+            else:
+                out += line + '\r\n'
+        data = out.encode('ascii')
+        if any(b == 0 or b >= 0x80 for b in data):
+            raise ValueError(f"{name}: solo ASCII de 7 bits sin NUL")
+        if not data:
+            raise ValueError(f"{name}: mensaje vacío")
+        messages.append((name, data))
+
+    for raw in text.splitlines():
+        if raw.startswith('##'):
+            continue
+        if raw.startswith('@@'):
+            raw = raw[1:]
+        elif raw.startswith('@'):
+            flush()
+            name, lines = raw[1:].strip().upper(), []
+            if not name.isidentifier():
+                raise ValueError(f"Nombre inválido: '{raw}'")
+            continue
+        if name is None:
+            if raw.strip():
+                raise ValueError(f"Texto fuera de un mensaje: '{raw}'")
+            continue
+        lines.append(raw)
+    flush()
+
+    names = [n for n, _ in messages]
+    dup = {n for n in names if names.count(n) > 1}
+    if dup:
+        raise ValueError(f"Mensajes repetidos: {', '.join(sorted(dup))}")
+    return messages
+
+
+def compress(messages):
+    """BPE: retorna (mensajes codificados, pares, profundidad máxima)"""
+    seqs = [list(data) for _, data in messages]
+    pairs = []
+    depth = {}
+
+    def sym_depth(s):
+        return depth.get(s, 0)
+
+    while len(pairs) < MAX_TOKENS:
+        counts = Counter()
+        for seq in seqs:
+            i = 0
+            while i < len(seq) - 1:
+                pair = (seq[i], seq[i + 1])
+                counts[pair] += 1
+                # "aaa" cuenta un solo par sin solapar
+                if i + 2 < len(seq) and seq[i + 2] == seq[i] == seq[i + 1]:
+                    i += 1
+                i += 1
+
+        best = None
+        for pair, n in counts.most_common():
+            if n < 3:
+                break
+            if 1 + max(sym_depth(pair[0]), sym_depth(pair[1])) <= MAX_DEPTH:
+                best = pair
+                break
+        if best is None:
+            break
+
+        token = 0x80 + len(pairs)
+        pairs.append(best)
+        depth[token] = 1 + max(sym_depth(best[0]), sym_depth(best[1]))
+
+        for k, seq in enumerate(seqs):
+            out, i = [], 0
+            while i < len(seq):
+                if i < len(seq) - 1 and (seq[i], seq[i + 1]) == best:
+                    out.append(token)
+                    i += 2
+                else:
+                    out.append(seq[i])
+                    i += 1
+            seqs[k] = out
+
+    return seqs, pairs, max(depth.values(), default=0)
+
+
+def expand(seq, pairs):
+    """Decodificar (misma lógica que mon_msg) para verificar"""
+    out, stack = [], []
+    for c in seq:
+        stack.append(c)
+        while stack:
+            c = stack.pop()
+            if c & 0x80:
+                a, b = pairs[c & 0x7F]
+                stack.append(b)
+                stack.append(a)
+            else:
+                out.append(c)
+    return bytes(out)
+
+
+def asm_bytes(data, per_line=16):
+    return [f"        .byte   {', '.join(f'${b:02X}' for b in data[i:i + per_line])}"
+            for i in range(0, len(data), per_line)]
+
+
+def write_outputs(base, source, messages, seqs, pairs, depth):
+    stack = (depth + 1 + 3) & ~3
+    lines = [f"; Generado por scripts/mkstrings.py desde {source} - no editar",
+             "",
+             "        .export         _mon_msg_pairs, _mon_msg_text",
+             "",
+             ".segment \"RODATA\"",
+             "",
+             "; Pares de los tokens $80.. (2 bytes por token)",
+             "_mon_msg_pairs:"]
+    lines += asm_bytes([b for pair in pairs for b in pair]) or ["        .byte   0, 0"]
+    lines += ["", "; Mensajes comprimidos, terminados en $00", "_mon_msg_text:"]
+    for (name, _), seq in zip(messages, seqs):
+        lines.append(f"; {name}")
+        lines += asm_bytes(seq + [0])
+    Path(f"{base}.s").write_text('\n'.join(lines) + '\n')
+
+    guard = "MON_STRINGS_H"
+    h = [f"/* Generado por scripts/mkstrings.py desde {source} - no editar */",
+         "",
+         f"#ifndef {guard}",
+         f"#define {guard}",
+         "",
+         "/* Pila del decodificador (profundidad máxima de tokens + 1) */",
+         f"#define MSG_DEPTH  {stack}",
+         ""]
+    width = max(len(n) for n, _ in messages) + 4
+    for i, (name, _) in enumerate(messages):
+        h.append(f"#define {('MSG_' + name).ljust(width)} {i}")
+    h += ["", f"#endif /* {guard} */"]
+    Path(f"{base}.h").write_text('\n'.join(h) + '\n')
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='Comprime los mensajes del monitor (BPE) y genera .s/.h',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    parser.add_argument('input', help='Archivo de mensajes (mon_strings.txt)')
+    parser.add_argument('-o', '--output', required=True, help='Ruta base de salida (sin extensión)')
+    args = parser.parse_args()
+
+    try:
+        source = Path(args.input)
+        messages = parse_messages(source.read_text(encoding='utf-8'))
+        if len(messages) > 256:
+            raise ValueError("Máximo 256 mensajes (índice de 8 bits)")
+        seqs, pairs, depth = compress(messages)
+        for (name, data), seq in zip(messages, seqs):
+            if expand(seq, pairs) != data:
+                raise RuntimeError(f"{name}: la decodificación no coincide")
+
+        write_outputs(args.output, source.name, messages, seqs, pairs, depth)
+
+        before = sum(len(d) + 1 for _, d in messages)           # Cadenas C con NUL
+        after = sum(len(s) + 1 for s in seqs) + 2 * len(pairs)
+        print(f"Mensajes: {len(messages)}, tokens: {len(pairs)}, profundidad: {depth}")
+        print(f"Antes:   {before:5d} bytes de cadenas")
+        print(f"Después: {after:5d} bytes ({after - 2 * len(pairs)} texto + {2 * len(pairs)} pares)")
+        print(f"Ahorro:  {before - after:5d} bytes de ROM ({100 * (before - after) // before}%)")
+    except Exception as e:
+        print(f"❌ Error: {e}")
+        exit(1)
@@ -0,0 +1,205 @@
+#!/usr/bin/env python3
+"""
+Medida de velocidad de la UART con el comando E del monitor
+
+  E n     el monitor envía n bytes del patrón (TX, monitor -> PC)
+  E n R   el monitor recibe y verifica n bytes del patrón (RX, PC -> monitor)
+
+Informa bytes/s en cada sentido frente a la velocidad teórica de la línea
+(baud / 10: 8N1). Funciona con un puerto serie o un pseudo-terminal
+(pyserial) o directamente contra la ROM en el emulador, donde el tiempo se
+mide en ciclos emulados y el PC emite a ritmo de línea sin esperar a la CPU.
+"""
+
+import argparse
+import re
+import sys
+import time
+
+PAT_FIRST = 0x21        # '!'..'~', igual que PAT_FIRST/PAT_LEN en monitor.c
+PAT_LEN = 94
+PROMPT = b'>'
+
+RESULT_RE = re.compile(rb'RX: (\d+) recibidos, (\d+) errores, (\d+) perdidos'
+                       rb'(?:, (\d+) desbordes)?( \(tiempo agotado\))?')
+
+
+def pattern(n):
+    return bytes(PAT_FIRST + i % PAT_LEN for i in range(n))
+
+
+def parse_int(value):
+    try:
+        return int(value, 0)
+    except ValueError:
+        raise argparse.ArgumentTypeError(f"Valor inválido: '{value}'")
+
+
+# ============================================
+# ENLACES
+# ============================================
+
+class SerialLink:
+    """Monitor real por un puerto serie o un pseudo-terminal"""
+
+    def __init__(self, port, baud, timeout):
+        try:
+            import serial
+        except ImportError:
+            raise RuntimeError("Falta pyserial (pip install pyserial)")
+        self.port = serial.Serial(port, baud, timeout=timeout)
+        self.port.reset_input_buffer()
+        self.port.write(b'\r')
+        self.read_until(PROMPT)
+
+    def read_until(self, token):
+        data = self.port.read_until(token)
+        if not data.endswith(token):
+            raise RuntimeError(f"Sin respuesta del monitor (esperando {token!r})")
+        return data
+
+    def read_exact(self, n):
+        data = bytearray()
+        while len(data) < n:
+            chunk = self.port.read(n - len(data))
+            if not chunk:
+                break
+            data += chunk
+        return bytes(data)
+
+    def tx_test(self, n):
+        """Retorna (bytes recibidos, segundos entre el primero y el último)"""
+        self.port.write(f"E {n:X}\r".encode('ascii'))
+        self.read_until(f"TX {n:04X}\r\n".encode('ascii'))
+        first = self.port.read(1)
+        t0 = time.perf_counter()
+        rest = self.read_exact(n - 1)
+        t1 = time.perf_counter()
+        self.read_until(PROMPT)
+        return first + rest, t1 - t0
+
+    def rx_test(self, n):
+        """Retorna (línea de resultado, segundos hasta el resultado, nota)"""
+        self.port.write(f"E {n:X} R\r".encode('ascii'))
+        self.read_until(f"RX {n:04X}\r\n".encode('ascii'))
+        t0 = time.perf_counter()
+        self.port.write(pattern(n))
+        self.port.flush()
+        self.read_until(b'RX: ')
+        t1 = time.perf_counter()
+        text = b'RX: ' + self.read_until(PROMPT)
+        return text, t1 - t0, ''
+
+
+class EmuLink:
+    """La ROM en emu6502.py; el tiempo son ciclos emulados"""
+
+    def __init__(self, rom, baud, max_cycles):
+        from emu6502 import CPU_HZ, System, Uart, load_rom
+        if not baud:
+            raise RuntimeError("El emulador necesita --baud > 0")
+        self.hz = CPU_HZ
+        self.max_cycles = max_cycles
+        self.uart = Uart(baud=baud)
+        self.uart.tx_times = []
+        self.system = System(load_rom(rom), self.uart)
+        self.system.reset()
+        self.run()
+
+    def run(self, until=None):
+        if self.system.run(max_cycles=self.system.cycles + self.max_cycles, until=until) == 'limit':
+            raise RuntimeError("Límite de ciclos alcanzado (--max-cycles)")
+
+    def command(self, line):
+        mark = len(self.uart.tx_log)
+        self.uart.feed(line.encode('ascii') + b'\r')
+        return mark
+
+    def tx_test(self, n):
+        mark = self.command(f"E {n:X}")
+        self.run()
+        log = self.uart.tx_log
+        header = log.find(f"TX {n:04X}\r\n".encode('ascii'), mark)
+        if header < 0:
+            raise RuntimeError("El monitor no respondió a E")
+        start = log.index(b'\n', header) + 1
+        data = bytes(log[start:start + n])
+        times = self.uart.tx_times
+        return data, (times[start + len(data) - 1] - times[start]) / self.hz
+
+    def rx_test(self, n):
+        mark = self.command(f"E {n:X} R")
+        header = f"RX {n:04X}\r\n".encode('ascii')
+        self.run(until=lambda s: len(s.uart.tx_log) > mark and s.uart.tx_log.endswith(header))
+        t0 = self.system.cycles
+        self.uart.stream(pattern(n), t0)
+        self.run()
+        text = bytes(self.uart.tx_log[mark:])
+        return text, (self.uart.last_read - t0) / self.hz, f"desbordes emulados: {self.uart.overruns}"
+
+
+# ============================================
+# INFORME
+# ============================================
+
+def rate_line(label, nbytes, seconds, line_rate):
+    rate = nbytes / seconds if seconds > 0 else 0.0
+    return (f"{label}: {nbytes} bytes en {seconds * 1000:.1f} ms = {rate:.0f} B/s "
+            f"({100.0 * rate / line_rate:.1f}% de la línea, hueco {line_rate - rate:.0f} B/s)")
+
+
+def bench(link, n, baud, which):
+    """Retorna el número de fallos (errores + perdidos)"""
+    line_rate = baud / 10
+    failures = 0
+    print(f"Línea: {baud} baud = {line_rate:.0f} B/s teóricos, {n} bytes por prueba")
+
+    if which in ('tx', 'both'):
+        data, seconds = link.tx_test(n)
+        expected = pattern(n)
+        errors = sum(1 for a, b in zip(data, expected) if a != b) + (n - len(data))
+        failures += errors
+        print(rate_line("TX monitor -> PC", max(len(data) - 1, 0), seconds, line_rate)
+              + (f", {errors} errores" if errors else ""))
+
+    if which in ('rx', 'both'):
+        text, seconds, note = link.rx_test(n)
+        m = RESULT_RE.search(text)
+        if not m:
+            raise RuntimeError(f"Resultado de E R no reconocido: {text!r}")
+        got, bad, lost = (int(g) for g in m.group(1, 2, 3))
+        failures += bad + lost
+        print(rate_line("RX PC -> monitor", got, seconds, line_rate))
+        print(f"    {got} recibidos, {bad} errores, {lost} perdidos"
+              + (f", {m.group(4).decode()} desbordes" if m.group(4) else "")
+              + (" (tiempo agotado)" if m.group(5) else "")
+              + (f"; {note}" if note else ""))
+    return failures
+
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(
+        description='Mide la velocidad de la UART del monitor (comando E)',
+        formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+    target = parser.add_mutually_exclusive_group(required=True)
+    target.add_argument('-p', '--port', help='Puerto serie o pseudo-terminal (p. ej. /dev/ttyUSB0, COM3)')
+    target.add_argument('--emu', metavar='ROM', help='Usar el emulador con esta ROM (output/rom.bin)')
+    parser.add_argument('-b', '--baud', type=int, default=115200, help='Velocidad de la línea')
+    parser.add_argument('-n', '--count', type=parse_int, default=0x1000, help='Bytes por prueba (1..0xFFFF)')
+    parser.add_argument('--only', choices=('tx', 'rx', 'both'), default='both', help='Sentido a medir')
+    parser.add_argument('--timeout', type=float, default=3.0, help='Segundos sin datos del puerto')
+    parser.add_argument('--max-cycles', type=int, default=200_000_000, help='Límite por prueba (emulador)')
+    args = parser.parse_args()
+
+    try:
+        if not 1 < args.count <= 0xFFFF:
+            raise ValueError("--count debe estar entre 2 y 0xFFFF")
+        if args.emu:
+            link = EmuLink(args.emu, args.baud, args.max_cycles)
+        else:
+            link = SerialLink(args.port, args.baud, args.timeout)
+        failures = bench(link, args.count, args.baud, args.only)
+    except Exception as e:
+        print(f"❌ Error: {e}")
+        exit(1)
+    sys.exit(1 if failures else 0)
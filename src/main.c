@@ -40,14 +40,14 @@ int main(void) {
     /* Inicializar UART */
     uart_init();
     
-    /* Mensaje de bienvenida */
-    uart_puts("\r\n");
-    uart_puts("##### 6502 SYSTEM READY #####\r\n");
-    uart_puts("Iniciando Monitor...\r\n");
-    
-    /* Iniciar y ejecutar el monitor en bucle */
-    monitor_init();
+    /* Iniciar el monitor; en caliente (RAM conservada) sin bienvenida */
+    if (monitor_init() == MON_BOOT_COLD) {
+        uart_puts("\r\n");
+        uart_puts("##### 6502 SYSTEM READY #####\r\n");
+        uart_puts("Iniciando Monitor...\r\n");
+    }
     
+    /* Ejecutar el monitor en bucle */
     while (1) {
         monitor_run();
         uart_puts("Reiniciando monitor...\r\n");
@@ -1,17 +1,14 @@
-; simple_vectors.s - Vectores básicos sin interrupciones
-; Solo para programas que NO usan I2C
+; simple_vectors.s - Vectores del 6502
+; NMI e IRQ/BRK se despachan por la tabla de vectores en RAM del monitor
+; (ver libs/monitor/mon_vectors.s), así los programas cargados pueden
+; instalar sus manejadores sin regenerar la ROM.
 
-.segment "CODE"
-
-nmi_handler:
-    rti
-
-irq_handler:
-    rti
+.import mon_nmi_entry
+.import mon_irq_entry
 
 .segment "VECTORS"
 
 ; Vectores de interrupción del 6502
-.addr   nmi_handler  ; NMI vector ($9FFA-$9FFB) 
-.addr   $8000        ; RESET vector ($9FFC-$9FFD) - Inicio de ROM donde está el startup de CC65
-.addr   irq_handler  ; IRQ vector ($9FFE-$9FFF)
+.addr   mon_nmi_entry  ; NMI vector ($9FFA-$9FFB) - JMP ($3A00)
+.addr   $8000          ; RESET vector ($9FFC-$9FFD) - Inicio de ROM donde está el startup de CC65
+.addr   mon_irq_entry  ; IRQ vector ($9FFE-$9FFF) - JMP ($3A02) o JMP ($3A04) si es BRK